@@ -0,0 +1,161 @@
+#include "arith.hpp"
+
+#include "dispatch.hpp"
+
+#include <doctest.h>
+
+// The batch forms run on the selected instruction set; see the arith kernels in batch_kernels.hpp.
+
+void AddSat16Batch(const int16_t* a, const int16_t* b, int16_t* out, size_t count) {
+    GetBatchKernels().add_sat16(a, b, out, count);
+}
+
+void SubSat16Batch(const int16_t* a, const int16_t* b, int16_t* out, size_t count) {
+    GetBatchKernels().sub_sat16(a, b, out, count);
+}
+
+void AddSat32Batch(const int32_t* a, const int32_t* b, int32_t* out, size_t count) {
+    GetBatchKernels().add_sat32(a, b, out, count);
+}
+
+void SubSat32Batch(const int32_t* a, const int32_t* b, int32_t* out, size_t count) {
+    GetBatchKernels().sub_sat32(a, b, out, count);
+}
+
+void MulhRound15Batch(const int16_t* a, const int16_t* b, int16_t* out, size_t count) {
+    GetBatchKernels().mulh_round15(a, b, out, count);
+}
+
+void MulhRound31Batch(const int32_t* a, const int32_t* b, int32_t* out, size_t count) {
+    GetBatchKernels().mulh_round31(a, b, out, count);
+}
+
+int64_t MacQ15(int64_t acc, const int16_t* a, const int16_t* b, size_t count) {
+    return GetBatchKernels().mac_q15(acc, a, b, count);
+}
+
+int64_t MacQ31(int64_t acc, const int32_t* a, const int32_t* b, size_t count) {
+    return GetBatchKernels().mac_q31(acc, a, b, count);
+}
+
+// Interesting 16-bit operands: the extremes, values around zero, and a few in between
+static const int16_t test_values16[] = {
+        INT16_MIN, INT16_MIN + 1, -0x4001, -0x4000, -0x3fff, -2, -1, 0, 1, 2, 0x3fff, 0x4000, 0x4001, INT16_MAX - 1,
+        INT16_MAX, 12345, -12345,
+};
+
+static const int32_t test_values32[] = {
+        INT32_MIN, INT32_MIN + 1, -0x40000001, -0x40000000, -0x3fffffff, -2, -1, 0, 1, 2, 0x3fffffff, 0x40000000,
+        0x40000001, INT32_MAX - 1, INT32_MAX, 123456789, -123456789,
+};
+
+constexpr size_t num_values16 = sizeof(test_values16) / sizeof(*test_values16);
+constexpr size_t num_values32 = sizeof(test_values32) / sizeof(*test_values32);
+
+TEST_CASE("Saturating and rounding scalar primitives") {
+    CHECK_EQ(AddSat16(INT16_MAX, 1), INT16_MAX);
+    CHECK_EQ(AddSat16(INT16_MIN, -1), INT16_MIN);
+    CHECK_EQ(SubSat16(INT16_MIN, 1), INT16_MIN);
+    CHECK_EQ(SubSat16(0, INT16_MIN), INT16_MAX);
+    CHECK_EQ(AddSat32(INT32_MAX, 1), INT32_MAX);
+    CHECK_EQ(AddSat32(INT32_MIN, INT32_MIN), INT32_MIN);
+    CHECK_EQ(SubSat32(INT32_MIN, 1), INT32_MIN);
+    CHECK_EQ(SubSat32(0, INT32_MIN), INT32_MAX);
+    CHECK_EQ(AddSat32(-5, 3), -2);
+
+    CHECK_EQ(MulhRound15(INT16_MIN, INT16_MIN), INT16_MAX);
+    CHECK_EQ(MulhRound15(0x4000, 0x4000), 0x2000);
+    CHECK_EQ(MulhRound15(1, 0x4000), 1);            // 0.5 LSB rounds up
+    CHECK_EQ(MulhRound15(-1, 0x4000), 0);           // -0.5 LSB rounds up as well
+    CHECK_EQ(MulhRound31(INT32_MIN, INT32_MIN), INT32_MAX);
+    CHECK_EQ(MulhRound31(0x40000000, 0x40000000), 0x20000000);
+    CHECK_EQ(MulhRound31(INT32_MIN, INT32_MAX), -INT32_MAX);
+
+    CHECK_EQ(MulShiftRound<12>(0x7fffffff, 0x1000), 0x7fffffff);   // would overflow in 32 bits
+    CHECK_EQ(MulShiftRound<4>(3, 3), 1);                           // 9/16 rounds to 1
+    CHECK_EQ(MulShiftRound<4>(7, 1), 0);                           // 7/16 rounds to 0
+    CHECK_EQ(MulShiftRound<0>(-3, 7), -21);
+    CHECK_EQ(ShiftRound<3>(12u), 2u);                               // 1.5 rounds up
+    CHECK_EQ(ShiftRound<3>(-12), -1);                               // -1.5 rounds up as well
+    CHECK_EQ(ShiftRound<0>(UINT32_MAX), UINT32_MAX);
+
+    CHECK_EQ(Mac32(-(INT64_C(1) << 62), INT32_MIN, INT32_MIN), 0);
+    CHECK_EQ(Mac32(5, -3, 4), -7);
+}
+
+TEST_CASE("Saturating and rounding batch primitives match scalar ones") {
+    // every pair of test values, so that each SIMD lane sees every combination
+    int16_t a16[num_values16 * num_values16], b16[num_values16 * num_values16], out16[num_values16 * num_values16];
+    int32_t a32[num_values32 * num_values32], b32[num_values32 * num_values32], out32[num_values32 * num_values32];
+
+    for (size_t i = 0; i < num_values16 * num_values16; i++) {
+        a16[i] = test_values16[i / num_values16];
+        b16[i] = test_values16[i % num_values16];
+    }
+
+    for (size_t i = 0; i < num_values32 * num_values32; i++) {
+        a32[i] = test_values32[i / num_values32];
+        b32[i] = test_values32[i % num_values32];
+    }
+
+    AddSat16Batch(a16, b16, out16, num_values16 * num_values16);
+    for (size_t i = 0; i < num_values16 * num_values16; i++) { CHECK_EQ(out16[i], AddSat16(a16[i], b16[i])); }
+
+    SubSat16Batch(a16, b16, out16, num_values16 * num_values16);
+    for (size_t i = 0; i < num_values16 * num_values16; i++) { CHECK_EQ(out16[i], SubSat16(a16[i], b16[i])); }
+
+    MulhRound15Batch(a16, b16, out16, num_values16 * num_values16);
+    for (size_t i = 0; i < num_values16 * num_values16; i++) { CHECK_EQ(out16[i], MulhRound15(a16[i], b16[i])); }
+
+    AddSat32Batch(a32, b32, out32, num_values32 * num_values32);
+    for (size_t i = 0; i < num_values32 * num_values32; i++) { CHECK_EQ(out32[i], AddSat32(a32[i], b32[i])); }
+
+    SubSat32Batch(a32, b32, out32, num_values32 * num_values32);
+    for (size_t i = 0; i < num_values32 * num_values32; i++) { CHECK_EQ(out32[i], SubSat32(a32[i], b32[i])); }
+
+    MulhRound31Batch(a32, b32, out32, num_values32 * num_values32);
+    for (size_t i = 0; i < num_values32 * num_values32; i++) { CHECK_EQ(out32[i], MulhRound31(a32[i], b32[i])); }
+}
+
+TEST_CASE("MacQ15, MacQ31") {
+    int16_t a16[num_values16 * num_values16], b16[num_values16 * num_values16];
+    int32_t a32[num_values32], b32[num_values32];
+
+    for (size_t i = 0; i < num_values16 * num_values16; i++) {
+        a16[i] = test_values16[i / num_values16];
+        b16[i] = test_values16[i % num_values16];
+    }
+
+    for (size_t i = 0; i < num_values32; i++) {
+        a32[i] = test_values32[i];
+        b32[i] = test_values32[num_values32 - 1 - i];
+    }
+
+    // all ones: (-1 * -1) pairs trigger the pmaddwd overflow case
+    int16_t mins[16];
+    for (auto& min : mins) {
+        min = INT16_MIN;
+    }
+
+    for (size_t count = 0; count <= num_values16 * num_values16; count++) {
+        int64_t expected = 7;
+
+        for (size_t i = 0; i < count; i++) {
+            expected += (int64_t) a16[i] * b16[i];
+        }
+
+        CHECK_EQ(MacQ15(7, a16, b16, count), expected);
+    }
+
+    for (size_t count = 0; count <= num_values32; count++) {
+        int64_t expected = -7;
+
+        for (size_t i = 0; i < count; i++) {
+            expected += (int64_t) a32[i] * b32[i];
+        }
+
+        CHECK_EQ(MacQ31(-7, a32, b32, count), expected);
+    }
+
+    CHECK_EQ(MacQ15(0, mins, mins, 16), INT64_C(16) << 30);
+}
@@ -0,0 +1,86 @@
+#ifndef FIXED_POINT_MATH_ARITH_HPP
+#define FIXED_POINT_MATH_ARITH_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Saturating and rounding fixed-point primitives.
+// Rounding is always "round half up", i.e. add half an LSB, then shift right arithmetically.
+// Scalar forms are inline. The batch forms run the kernels in batch_kernels.hpp for the instruction set selected by
+// dispatch.hpp, on the 16-bit and 64-bit backend operations (paddsw/psubsw/pmulhrsw/pmaddwd/pmuldq on x86).
+
+inline int16_t AddSat16(int16_t a, int16_t b) {
+    int32_t sum = (int32_t) a + b;
+    return (int16_t) (sum > INT16_MAX ? INT16_MAX : sum < INT16_MIN ? INT16_MIN : sum);
+}
+
+inline int16_t SubSat16(int16_t a, int16_t b) {
+    int32_t diff = (int32_t) a - b;
+    return (int16_t) (diff > INT16_MAX ? INT16_MAX : diff < INT16_MIN ? INT16_MIN : diff);
+}
+
+inline int32_t AddSat32(int32_t a, int32_t b) {
+    int64_t sum = (int64_t) a + b;
+    return (int32_t) (sum > INT32_MAX ? INT32_MAX : sum < INT32_MIN ? INT32_MIN : sum);
+}
+
+inline int32_t SubSat32(int32_t a, int32_t b) {
+    int64_t diff = (int64_t) a - b;
+    return (int32_t) (diff > INT32_MAX ? INT32_MAX : diff < INT32_MIN ? INT32_MIN : diff);
+}
+
+// Q15 x Q15 -> Q15 (same as pmulhrsw, except that -1 * -1 saturates to INT16_MAX instead of wrapping)
+inline int16_t MulhRound15(int16_t a, int16_t b) {
+    int32_t product = ((int32_t) a * b + (1 << 14)) >> 15;
+    return (int16_t) (product > INT16_MAX ? INT16_MAX : product);
+}
+
+// Q31 x Q31 -> Q31, -1 * -1 saturates to INT32_MAX
+inline int32_t MulhRound31(int32_t a, int32_t b) {
+    int64_t product = ((int64_t) a * b + (INT64_C(1) << 30)) >> 31;
+    return (int32_t) (product > INT32_MAX ? INT32_MAX : product);
+}
+
+// x / 2**shift, rounded. For unsigned types this compiles to an add and a plain shift, without any sign fix-up.
+template <int shift, typename T>
+constexpr T ShiftRound(T x) {
+    static_assert(shift >= 0 && shift < (int) sizeof(T) * 8, "shift out of range");
+
+    if constexpr (shift == 0) {
+        return x;
+    }
+    else {
+        return (x + ((T) 1 << (shift - 1))) >> shift;
+    }
+}
+
+// (a * b) / 2**shift, rounded. The product is formed in 64 bits, so it cannot overflow;
+// the caller is responsible for the result fitting in 32 bits.
+template <int shift>
+int32_t MulShiftRound(int32_t a, int32_t b) {
+    return (int32_t) ShiftRound<shift>((int64_t) a * b);
+}
+
+// Fused multiply-accumulate into a 64-bit accumulator
+inline int64_t Mac32(int64_t acc, int32_t a, int32_t b) {
+    return acc + (int64_t) a * b;
+}
+
+// The batch forms are compiled into the library, so they are not available with FIXED_POINT_MATH_HEADER_ONLY
+#ifndef FIXED_POINT_MATH_HEADER_ONLY
+
+// Batch forms. Input and output arrays may alias, but must not partially overlap.
+void AddSat16Batch(const int16_t* a, const int16_t* b, int16_t* out, size_t count);
+void SubSat16Batch(const int16_t* a, const int16_t* b, int16_t* out, size_t count);
+void AddSat32Batch(const int32_t* a, const int32_t* b, int32_t* out, size_t count);
+void SubSat32Batch(const int32_t* a, const int32_t* b, int32_t* out, size_t count);
+void MulhRound15Batch(const int16_t* a, const int16_t* b, int16_t* out, size_t count);
+void MulhRound31Batch(const int32_t* a, const int32_t* b, int32_t* out, size_t count);
+
+// acc + sum(a[i] * b[i]), exact for any count that does not overflow the 64-bit accumulator
+int64_t MacQ15(int64_t acc, const int16_t* a, const int16_t* b, size_t count);
+int64_t MacQ31(int64_t acc, const int32_t* a, const int32_t* b, size_t count);
+
+#endif
+
+#endif
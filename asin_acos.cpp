@@ -0,0 +1,93 @@
+#include "asin_acos.hpp"
+#include "sin_cos.hpp"
+
+#include <doctest.h>
+
+#include <math.h>
+
+// Largest difference from the exact result, in units of the output angle
+template <int angle_bits, typename Ratio_t, int frac_bits, typename Func>
+static double MaxError(Func func, double (*reference)(double)) {
+    constexpr int32_t one = INT32_C(1) << frac_bits;
+    constexpr int32_t step = frac_bits > 12 ? (1 << (frac_bits - 12)) - 1 : 1;
+
+    double max_error = 0;
+
+    for (int32_t ratio = -one; ratio <= one; ratio += step) {
+        double exact = reference((double) ratio / one) / (2 * M_PI) * pow(2, angle_bits);
+        max_error = fmax(max_error, fabs(func((Ratio_t) ratio) - exact));
+    }
+
+    return max_error;
+}
+
+// Every entry against libm, rounded to nearest
+template <int table_bits>
+static void CheckAsinTable() {
+    const auto& table = asin_table_v<table_bits>.values;
+    const size_t last = (size_t) 1 << table_bits;
+
+    for (size_t i = 0; i <= last; i++) {
+        INFO("table_bits = " << table_bits << ", i = " << i);
+        REQUIRE_EQ(table[i], (uint16_t) round(asin(0.5 * i / last) / (M_PI / 2) * 65536));
+    }
+}
+
+TEST_CASE("AsinTable") {
+    CheckAsinTable<5>();
+    CheckAsinTable<6>();
+    CheckAsinTable<7>();
+    CheckAsinTable<10>();
+
+    for (size_t i = 0; i < AsinSqrtTable::size; i++) {
+        INFO("i = " << i);
+        REQUIRE_EQ(asin_sqrt_table[i], (uint16_t) round(sqrt((32.0 + i) / 128) * 32768));
+    }
+}
+
+TEST_CASE("AsinSqrt") {
+    for (uint64_t n = 0; n < (UINT64_C(1) << 30); n = n * 33 / 32 + 1) {
+        double exact = sqrt((double) n);
+        REQUIRE_LE(fabs(AsinSqrt((uint32_t) n) - exact), 1.25);
+    }
+}
+
+TEST_CASE("Asin<angle_bits, int32_t>(int32_t), Acos<angle_bits, int32_t>(int32_t)") {
+    CHECK_EQ(Asin<12, int32_t>(0), 0);
+    CHECK_EQ(Asin<12, int32_t>(4096), 1024);
+    CHECK_EQ(Asin<12, int32_t>(-4096), -1024);
+    CHECK_EQ(Asin<12, int32_t>(2048), 341);
+    CHECK_EQ(Asin<16, int32_t>(2048), 5461);
+    CHECK_EQ(Acos<12, int32_t>(4096), 0);
+    CHECK_EQ(Acos<12, int32_t>(0), 1024);
+    CHECK_EQ(Acos<12, int32_t>(-4096), 2048);
+    CHECK_EQ(Acos<16, int32_t>(-2048), 21845);
+
+    // out of range ratios are clamped
+    CHECK_EQ(Asin<12, int32_t>(5000), 1024);
+    CHECK_EQ(Asin<12, int32_t>(INT32_MIN), -1024);
+    CHECK_EQ(Acos<12, int32_t>(INT32_MAX), 0);
+
+    for (int32_t ratio = 0; ratio <= 4096; ratio++) {
+        REQUIRE_EQ(Asin<16, int32_t>(-ratio), -Asin<16, int32_t>(ratio));
+        REQUIRE_EQ(Acos<16, int32_t>(-ratio), 32768 - Acos<16, int32_t>(ratio));
+    }
+
+    CHECK_LE(MaxError<12, int32_t, 12>(Asin<12, int32_t>, asin), 0.55);
+    CHECK_LE(MaxError<12, int32_t, 12>(Acos<12, int32_t>, acos), 0.55);
+    CHECK_LE(MaxError<16, int32_t, 12>(Asin<16, int32_t>, asin), 1.25);
+    CHECK_LE(MaxError<16, int32_t, 12>(Acos<16, int32_t>, acos), 1.25);
+
+    // wider ratios; the 16 fractional bits of the intermediate results start to show near +/-1 and beyond 18 angle bits
+    CHECK_LE(MaxError<16, int16_t, 14>(Asin<16, int16_t, 14>, asin), 1.25);
+    CHECK_LE(MaxError<16, int32_t, 20>(Acos<16, int32_t, 20>, acos), 2);
+    CHECK_LE(MaxError<20, int32_t, 16>(Asin<20, int32_t, 16>, asin), 16);
+}
+
+TEST_CASE("Asin(Sin(angle))") {
+    // Sin is flat towards +/-0.5pi, so its 12-bit output can only pin down angles well away from there
+    for (int32_t angle = -640; angle <= 640; angle++) {
+        REQUIRE_LE(abs(Asin<12, int32_t>(Sin<12, int32_t>(angle)) - angle), 1);
+        REQUIRE_LE(abs(Acos<12, int32_t>(Cos<12, int32_t>(angle + 1024)) - (angle + 1024)), 1);
+    }
+}
@@ -0,0 +1,128 @@
+#ifndef FIXED_POINT_MATH_ASIN_ACOS_HPP
+#define FIXED_POINT_MATH_ASIN_ACOS_HPP
+
+#include <stdint.h>
+
+#include "arith.hpp"
+#include "asin_table.hpp"
+#include "instrument.hpp"
+#include "log2.hpp"
+
+// Inverse of Sin/Cos: the input is a ratio with frac_bits fractional bits (by default the 1+12 bits that Sin
+// returns), the output is a binary angle of angle_bits bits per full turn, like the input of Sin.
+// Ratios outside [-1, 1] are clamped.
+//
+// For |x| <= 0.5 a table of asin over [0, 0.5] is interpolated linearly. Towards +/-1 asin gets infinitely steep,
+// so there the range is reduced with asin(x) = pi/2 - 2 asin(sqrt((1 - x) / 2)), which maps back into the table.
+// Intermediate results have 16 fractional bits, so precision stops improving beyond angle_bits = 18.
+
+// MAX ERROR against asin() of the same ratio, Asin<12>: 0.53 LSB, Asin<16>: 1.21 LSB
+#define ASIN_TABLE_BITS 6
+
+// asin over [0, 0.5] in units of 2**-16 of a quarter turn; see asin_table.hpp for this and the square roots
+inline constexpr const uint16_t (&asin_table)[AsinTable<ASIN_TABLE_BITS>::size] = asin_table_v<ASIN_TABLE_BITS>.values;
+inline constexpr const uint16_t (&asin_sqrt_table)[AsinSqrtTable::size] = asin_sqrt_table_v.values;
+
+// sqrt(n) for n < 2**30, to within about one unit. This is precise enough for the range reduction and, unlike the
+// bisection in Sqrtu, only costs a handful of instructions: n is brought into [2**28, 2**30) by an even shift and a
+// table of square roots over that range is interpolated linearly.
+inline uint32_t AsinSqrt(uint32_t n) {
+    if (n == 0) {
+        return 0;
+    }
+
+    int shift = (29 - Log2floor(n)) & ~1;
+    uint32_t normalized = n << shift;
+
+    uint32_t index = (normalized >> 23) - 32;
+    uint32_t interp_pos = normalized & ((UINT32_C(1) << 23) - 1);
+
+    uint32_t delta = asin_sqrt_table[index + 1] - asin_sqrt_table[index];
+    uint32_t root = asin_sqrt_table[index] + (uint32_t) ShiftRound<23>((uint64_t) delta * interp_pos);
+
+    // sqrt(normalized) = sqrt(n) * 2**(shift / 2)
+    return (root + ((UINT32_C(1) << (shift / 2)) >> 1)) >> (shift / 2);
+}
+
+// asin(s / 2**16) in units of 2**-16 of a quarter turn, for s in [0, 2**15]
+inline uint32_t AsinQuarterTurns(uint32_t s) {
+    // the table covers [0, 0.5], that is 15 bits of s
+    constexpr int interp_bits = 15 - ASIN_TABLE_BITS;
+    constexpr uint32_t interp_mask = (UINT32_C(1) << interp_bits) - 1;
+    constexpr uint32_t last_index = (UINT32_C(1) << ASIN_TABLE_BITS) - 1;
+
+    uint32_t index = s >> interp_bits;
+    uint32_t interp_pos = s & interp_mask;
+
+    if (index > last_index) {
+        // s == 0.5 exactly: interpolate to the very end of the last segment
+        index = last_index;
+        interp_pos = interp_mask + 1;
+    }
+
+    // The table is increasing, so the step is never negative
+    uint32_t delta = asin_table[index + 1] - asin_table[index];
+    return asin_table[index] + ShiftRound<interp_bits>(delta * interp_pos);
+}
+
+template <int angle_bits, typename Ratio_t, int frac_bits = 12>
+int32_t Asin(Ratio_t ratio) {
+    static_assert(angle_bits >= 2 && angle_bits <= 31, "angle_bits must be between 2 and 31");
+    static_assert(frac_bits >= 1 && frac_bits <= 30, "frac_bits must be between 1 and 30");
+
+    FIXED_POINT_MATH_INSTRUMENT_CALL("Asin", angle_bits, frac_bits);
+
+    constexpr int32_t one = INT32_C(1) << frac_bits;
+
+    int32_t x = (int32_t) ratio;
+
+    if (x > one) {
+        x = one;
+    }
+    else if (x < -one) {
+        x = -one;
+    }
+
+    // |x| in Q16
+    uint32_t magnitude = (uint32_t) (x < 0 ? -x : x);
+
+    if constexpr (frac_bits <= 16) {
+        magnitude <<= 16 - frac_bits;
+    }
+    else {
+        magnitude = ShiftRound<frac_bits - 16>(magnitude);
+    }
+
+    uint32_t quarter_turns;
+
+    if (magnitude <= (UINT32_C(1) << 15)) {
+        quarter_turns = AsinQuarterTurns(magnitude);
+    }
+    else {
+        // sqrt((1 - x) / 2) in Q16 is sqrt((1 - x) * 2**15) with 1 - x in Q16, which is below 2**30 here
+        uint32_t s = AsinSqrt(((UINT32_C(1) << 16) - magnitude) << 15);
+        quarter_turns = (UINT32_C(1) << 16) - 2 * AsinQuarterTurns(s);
+    }
+
+    // A quarter turn is 2**(angle_bits - 2)
+    int32_t angle;
+
+    if constexpr (angle_bits <= 18) {
+        angle = (int32_t) ShiftRound<18 - angle_bits>(quarter_turns);
+    }
+    else {
+        angle = (int32_t) (quarter_turns << (angle_bits - 18));
+    }
+
+    return x < 0 ? -angle : angle;
+}
+
+template <int angle_bits, typename Ratio_t, int frac_bits = 12>
+int32_t Acos(Ratio_t ratio) {
+    constexpr int32_t quarter_turn = INT32_C(1) << (angle_bits - 2);
+
+    // acos(x) = pi/2 - asin(x); Asin is odd, so Acos(-x) = half turn - Acos(x) exactly
+    return quarter_turn - Asin<angle_bits, Ratio_t, frac_bits>(ratio);
+}
+
+#endif
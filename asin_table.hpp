@@ -0,0 +1,88 @@
+#ifndef FIXED_POINT_MATH_ASIN_TABLE_HPP
+#define FIXED_POINT_MATH_ASIN_TABLE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Tables for Asin and Acos, generated at compile time.
+//
+// AsinTable<table_bits> holds asin(i / 2**table_bits * 0.5) in units of 2**-16 of a quarter turn, rounded to
+// nearest, for i in [0, 2**table_bits]. The series below leaves each entry many orders of magnitude closer than half
+// a unit to the exact value. Only 0 and 0.5 have an asin that is a rational multiple of pi (Niven's theorem), and
+// 0.5 maps to a third of a quarter turn, so no entry lies on a rounding tie. asin_acos.cpp checks the tables against
+// libm.
+
+// Anything between 0 and 0.5
+constexpr long double AsinSeries(long double x) {
+    long double x2 = x * x;
+    long double term = x;
+    long double sum = x;
+
+    // the terms shrink by at least x**2 <= 1/4 each, so after 40 of them the next is below 10**-24
+    for (int n = 1; n <= 40; n++) {
+        term = term * x2 * (2 * n - 1) * (2 * n - 1) / ((2 * n) * (2 * n + 1));
+        sum += term;
+    }
+
+    return sum;
+}
+
+template <int table_bits>
+struct AsinTable {
+    static_assert(table_bits >= 0 && table_bits <= 15, "table_bits must be between 0 and 15");
+
+    static constexpr size_t size = (size_t(1) << table_bits) + 1;
+
+    uint16_t values[size];
+};
+
+template <int table_bits>
+constexpr AsinTable<table_bits> MakeAsinTable() {
+    constexpr long double half_pi = 1.570796326794896619231321691639751442L;
+    constexpr int64_t last = int64_t(1) << table_bits;
+
+    AsinTable<table_bits> table = {};
+
+    for (int64_t i = 0; i <= last; i++) {
+        long double asin = AsinSeries(0.5L * i / last);
+        table.values[i] = (uint16_t) (int64_t) (asin / half_pi * 65536 + 0.5L);
+    }
+
+    return table;
+}
+
+template <int table_bits>
+inline constexpr AsinTable<table_bits> asin_table_v = MakeAsinTable<table_bits>();
+
+// Square roots for AsinSqrt: sqrt(m / 2**30) * 2**15, rounded to nearest, for m in [2**28, 2**30] in steps of 2**23.
+// That is sqrt((32 + i) * 2**23), which is worked out exactly in integers; it is never halfway between two integers.
+struct AsinSqrtTable {
+    static constexpr size_t size = 97;
+
+    uint16_t values[size];
+};
+
+constexpr AsinSqrtTable MakeAsinSqrtTable() {
+    AsinSqrtTable table = {};
+
+    for (size_t i = 0; i < table.size; i++) {
+        uint64_t m = (uint64_t) (32 + i) << 23;
+
+        // floor(sqrt(m)) by bisection, then rounded up if m > (root + 1/2)**2, i.e. m > root**2 + root
+        uint64_t root = 0;
+
+        for (uint64_t bit = UINT64_C(1) << 16; bit; bit >>= 1) {
+            if ((root + bit) * (root + bit) <= m) {
+                root += bit;
+            }
+        }
+
+        table.values[i] = (uint16_t) (m > root * root + root ? root + 1 : root);
+    }
+
+    return table;
+}
+
+inline constexpr AsinSqrtTable asin_sqrt_table_v = MakeAsinSqrtTable();
+
+#endif
@@ -0,0 +1,443 @@
+// Picks the fastest configuration that stays within an error budget on this machine, and writes it out as a header
+// with a preset for policy.hpp. Not a test: build the `autotune` target in Release mode and run it by hand, e.g.
+//
+//     autotune --sin-max-error 1.5 --sqrt-max-error 0.01 --angle-bits 16 --output tuned.hpp
+//
+// and then call Sin<Tuned, 16>(angle) and so on. Options, all optional:
+//
+//     --sin-max-error LSB     budget for Sin and Cos, in units of the 12-bit result (default 1.5)
+//     --sqrt-max-error REL    budget for Sqrtu, relative as in policy.hpp (default 1/128)
+//     --tan-max-error REL     budget for Tan, relative as in policy.hpp (default 1/4096)
+//     --angle-bits N          angle width the functions will be called with: 12, 16, 20 or 24 (default 16)
+//     --sqrt-max N            largest number passed to Sqrtu (default 2**32 - 1)
+//     --output FILE           where to write the header (default tuned.hpp)
+//
+// Angles are drawn uniformly over the full turn and numbers uniformly over [0, sqrt-max]. Errors are measured over
+// every input where that takes at most 2**22 evaluations, otherwise over 2**22 evenly spaced ones.
+//
+// The candidates are the configurations that can coexist in one build: the two sin tables (sin_table, which is what
+// SIN_TABLE_BITS selects, and sin_fine_table) with their interpolation orders, every Sqrtu tolerance and iteration
+// count, every Tan Newton step count, and every batch kernel instruction set the CPU supports.
+
+#include "batch.hpp"
+#include "dispatch.hpp"
+#include "policy.hpp"
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+constexpr size_t NUM_TIMING_INPUTS = 1 << 16;
+constexpr uint64_t MAX_ERROR_EVALUATIONS = 1 << 22;
+
+struct Options {
+    double sin_max_error = 1.5;
+    double sqrt_max_error = 1.0 / 128;
+    double tan_max_error = 1.0 / 4096;
+    int angle_bits = 16;
+    uint32_t sqrt_max = UINT32_MAX;
+    const char* output = "tuned.hpp";
+};
+
+// Inputs for measuring the error: [0, max] completely if it is small enough, else evenly spaced
+static std::vector<uint32_t> ErrorInputs(uint64_t max) {
+    uint64_t stride = (max + MAX_ERROR_EVALUATIONS) / MAX_ERROR_EVALUATIONS;
+    std::vector<uint32_t> inputs;
+
+    for (uint64_t value = 0; value <= max; value += stride) {
+        inputs.push_back((uint32_t) value);
+    }
+
+    return inputs;
+}
+
+static std::vector<uint32_t> TimingInputs(uint64_t max) {
+    std::vector<uint32_t> inputs(NUM_TIMING_INPUTS);
+    uint64_t state = 0x12345678;
+
+    for (auto& input : inputs) {
+        state = state * 6364136223846793005 + 1442695040888963407;
+        input = (uint32_t) ((state >> 32) % (max + 1));
+    }
+
+    return inputs;
+}
+
+// Best of several runs, each repeated for at least 20 ms
+template <typename Func>
+static double NsPerElement(size_t count, Func func) {
+    double best = INFINITY;
+
+    for (int run = 0; run < 3; run++) {
+        auto start = std::chrono::steady_clock::now();
+        double ns = 0;
+        int repeats = 0;
+
+        while (ns < 20e6) {
+            func();
+            repeats++;
+            ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        best = fmin(best, ns / ((double) count * repeats));
+    }
+
+    return best;
+}
+
+using ArrayFunc = void (*)(const int32_t* in, int32_t* out, size_t count);
+
+template <typename Policy, int angle_bits>
+static void SinArray(const int32_t* angles, int32_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = Sin<Policy, angle_bits, int32_t>(angles[i]);
+    }
+}
+
+template <typename Policy, int angle_bits>
+static void CosArray(const int32_t* angles, int32_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = Cos<Policy, angle_bits, int32_t>(angles[i]);
+    }
+}
+
+template <int newton_steps, int angle_bits>
+static void TanArray(const int32_t* angles, int32_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = Tan<angle_bits, int32_t, newton_steps>(angles[i]);
+    }
+}
+
+struct SinCandidate {
+    std::string name;
+    SinTableKind table;
+    int interpolation_order;
+    ArrayFunc sin;
+    ArrayFunc cos;
+    const BatchKernels* kernels;        // instead of sin and cos
+};
+
+template <typename Policy, int angle_bits>
+static SinCandidate ScalarSinCandidate(const char* name) {
+    return {name, Policy::sin_table_kind, Policy::sin_interpolation_order, SinArray<Policy, angle_bits>,
+            CosArray<Policy, angle_bits>, nullptr};
+}
+
+template <int angle_bits>
+static std::vector<SinCandidate> SinCandidates() {
+    std::vector<SinCandidate> candidates = {
+            ScalarSinCandidate<Fast, angle_bits>("Sin, fine table, nearest entry"),
+            ScalarSinCandidate<Balanced, angle_bits>("Sin, sin_table, linear"),
+            ScalarSinCandidate<Exact, angle_bits>("Sin, fine table, linear"),
+    };
+
+    for (int i = 0; i < NUM_ISAS; i++) {
+        if (auto kernels = GetBatchKernels((Isa) i)) {
+            candidates.push_back({std::string("SinBatch, sin_table, linear [") + IsaName((Isa) i) + "]",
+                                  SinTableKind::coarse, 1, nullptr, nullptr, kernels});
+        }
+    }
+
+    return candidates;
+}
+
+template <int angle_bits>
+static std::vector<ArrayFunc> TanCandidates() {
+    return {TanArray<0, angle_bits>, TanArray<1, angle_bits>, TanArray<2, angle_bits>};
+}
+
+// As spelled in the enum, rather than IsaName
+static const char* IsaEnumName(Isa isa) {
+    static const char* const names[NUM_ISAS] = {"scalar", "sse42", "avx2", "avx512"};
+    return names[(int) isa];
+}
+
+static void PrintCandidate(const std::string& name, double error, double ns, bool within_budget) {
+    printf("  %-48s error %10.6f  %8.3f ns/element%s\n", name.c_str(), error, ns,
+           within_budget ? "" : "  (over budget)");
+}
+
+static bool ParseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 == argc) {
+            fprintf(stderr, "%s: missing value\n", argv[i]);
+            return false;
+        }
+
+        const char* value = argv[++i];
+
+        if (!strcmp(argv[i - 1], "--sin-max-error")) {
+            options.sin_max_error = atof(value);
+        }
+        else if (!strcmp(argv[i - 1], "--sqrt-max-error")) {
+            options.sqrt_max_error = atof(value);
+        }
+        else if (!strcmp(argv[i - 1], "--tan-max-error")) {
+            options.tan_max_error = atof(value);
+        }
+        else if (!strcmp(argv[i - 1], "--angle-bits")) {
+            options.angle_bits = atoi(value);
+        }
+        else if (!strcmp(argv[i - 1], "--sqrt-max")) {
+            options.sqrt_max = (uint32_t) strtoul(value, nullptr, 0);
+        }
+        else if (!strcmp(argv[i - 1], "--output")) {
+            options.output = value;
+        }
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i - 1]);
+            return false;
+        }
+    }
+
+    if (options.angle_bits != 12 && options.angle_bits != 16 && options.angle_bits != 20 && options.angle_bits != 24) {
+        fprintf(stderr, "--angle-bits must be 12, 16, 20 or 24\n");
+        return false;
+    }
+
+    return true;
+}
+
+template <int angle_bits>
+static bool Tune(const Options& options) {
+    const uint64_t angle_max = (UINT64_C(1) << angle_bits) - 1;
+    auto error_angles_u = ErrorInputs(angle_max);
+    auto timing_angles_u = TimingInputs(angle_max);
+    std::vector<int32_t> error_angles(error_angles_u.begin(), error_angles_u.end());
+    std::vector<int32_t> timing_angles(timing_angles_u.begin(), timing_angles_u.end());
+    std::vector<int32_t> out(error_angles.size());
+    std::vector<int32_t> timing_out(NUM_TIMING_INPUTS);
+
+    // Sin and Cos
+    printf("Sin, Cos<%d>, budget %g LSB\n", angle_bits, options.sin_max_error);
+
+    SinCandidate sin_best = {};
+    double sin_best_error = 0;
+    double sin_best_ns = INFINITY;
+
+    for (const auto& candidate : SinCandidates<angle_bits>()) {
+        auto run = [&](const int32_t* in, int32_t* result, size_t count, bool cosine) {
+            if (candidate.kernels) {
+                (cosine ? candidate.kernels->cos : candidate.kernels->sin)(in, result, count, angle_bits);
+            }
+            else {
+                (cosine ? candidate.cos : candidate.sin)(in, result, count);
+            }
+        };
+
+        double error = 0;
+
+        for (bool cosine : {false, true}) {
+            run(error_angles.data(), out.data(), error_angles.size(), cosine);
+
+            for (size_t i = 0; i < error_angles.size(); i++) {
+                double x = 2 * M_PI * (double) error_angles_u[i] / (double) (angle_max + 1);
+                error = fmax(error, fabs(out[i] - (cosine ? cos(x) : sin(x)) * 4096));
+            }
+        }
+
+        double ns = NsPerElement(NUM_TIMING_INPUTS, [&] {
+            run(timing_angles.data(), timing_out.data(), NUM_TIMING_INPUTS, false);
+        });
+
+        bool within_budget = error <= options.sin_max_error;
+        PrintCandidate(candidate.name, error, ns, within_budget);
+
+        if (within_budget && ns < sin_best_ns) {
+            sin_best = candidate;
+            sin_best_error = error;
+            sin_best_ns = ns;
+        }
+    }
+
+    // Sqrtu, every tolerance with the fewest iterations that reach its full precision, on every instruction set
+    printf("Sqrtu, numbers up to %u, budget %g relative\n", options.sqrt_max, options.sqrt_max_error);
+
+    auto error_numbers = ErrorInputs(options.sqrt_max);
+    auto timing_numbers = TimingInputs(options.sqrt_max);
+    std::vector<uint32_t> roots(error_numbers.size());
+    std::vector<uint32_t> timing_roots(NUM_TIMING_INPUTS);
+    // every instruction set gives the same results, so the fastest one measures the error
+    const BatchKernels& kernels = GetBatchKernels();
+
+    auto sqrt_error = [&](int tolerance_bits, int max_iterations) {
+        kernels.sqrtu(error_numbers.data(), roots.data(), error_numbers.size(), tolerance_bits, max_iterations);
+
+        double error = 0;
+
+        for (size_t i = 0; i < error_numbers.size(); i++) {
+            double exact = sqrt((double) error_numbers[i]);
+
+            if (exact > 0) {
+                error = fmax(error, (fabs(roots[i] - exact) - 1) / exact);
+            }
+        }
+
+        return error;
+    };
+
+    int sqrt_best_tolerance = 0;
+    int sqrt_best_iterations = 0;
+    Isa sqrt_best_isa = Isa::scalar;
+    double sqrt_best_error = 0;
+    double sqrt_best_ns = INFINITY;
+
+    for (int tolerance_bits = 1; tolerance_bits <= 16; tolerance_bits++) {
+        double full_error = sqrt_error(tolerance_bits, 16);
+        int max_iterations = 1;
+
+        while (max_iterations < 16 && sqrt_error(tolerance_bits, max_iterations) > full_error) {
+            max_iterations++;
+        }
+
+        bool within_budget = full_error <= options.sqrt_max_error;
+
+        for (int i = 0; i < NUM_ISAS; i++) {
+            auto isa_kernels = GetBatchKernels((Isa) i);
+
+            if (!isa_kernels) {
+                continue;
+            }
+
+            double ns = NsPerElement(NUM_TIMING_INPUTS, [&] {
+                isa_kernels->sqrtu(timing_numbers.data(), timing_roots.data(), NUM_TIMING_INPUTS, tolerance_bits,
+                                   max_iterations);
+            });
+
+            char name[64];
+            snprintf(name, sizeof(name), "Sqrtu<%d, %d> [%s]", tolerance_bits, max_iterations, IsaName((Isa) i));
+            PrintCandidate(name, fmax(full_error, 0), ns, within_budget);
+
+            if (within_budget && ns < sqrt_best_ns) {
+                sqrt_best_tolerance = tolerance_bits;
+                sqrt_best_iterations = max_iterations;
+                sqrt_best_isa = (Isa) i;
+                sqrt_best_error = fmax(full_error, 0);
+                sqrt_best_ns = ns;
+            }
+        }
+    }
+
+    // Tan
+    printf("Tan<%d>, budget %g relative\n", angle_bits, options.tan_max_error);
+
+    int tan_best_steps = -1;
+    double tan_best_error = 0;
+    double tan_best_ns = INFINITY;
+    auto tan_candidates = TanCandidates<angle_bits>();
+
+    for (int newton_steps = 0; newton_steps < (int) tan_candidates.size(); newton_steps++) {
+        tan_candidates[newton_steps](error_angles.data(), out.data(), error_angles.size());
+
+        double error = 0;
+
+        for (size_t i = 0; i < error_angles.size(); i++) {
+            double exact = tan(2 * M_PI * (double) error_angles_u[i] / (double) (angle_max + 1)) * 4096;
+
+            // the poles, and anything that saturates, are exact by definition
+            if (fabs(exact) < INT32_MAX && fabs(out[i] - exact) > 1) {
+                error = fmax(error, fabs(out[i] - exact) / fabs(exact));
+            }
+        }
+
+        double ns = NsPerElement(NUM_TIMING_INPUTS, [&] {
+            tan_candidates[newton_steps](timing_angles.data(), timing_out.data(), NUM_TIMING_INPUTS);
+        });
+
+        bool within_budget = error <= options.tan_max_error;
+        PrintCandidate("Tan, " + std::to_string(newton_steps) + " Newton steps", error, ns, within_budget);
+
+        if (within_budget && ns < tan_best_ns) {
+            tan_best_steps = newton_steps;
+            tan_best_error = error;
+            tan_best_ns = ns;
+        }
+    }
+
+    if (!sin_best.sin && !sin_best.kernels) {
+        fprintf(stderr, "no configuration of Sin meets the budget\n");
+        return false;
+    }
+
+    if (sqrt_best_tolerance == 0) {
+        fprintf(stderr, "no configuration of Sqrtu meets the budget\n");
+        return false;
+    }
+
+    if (tan_best_steps < 0) {
+        fprintf(stderr, "no configuration of Tan meets the budget\n");
+        return false;
+    }
+
+    // Instruction set of the winning SinBatch, if a batch kernel won
+    Isa sin_isa = Isa::scalar;
+
+    for (int i = 0; i < NUM_ISAS; i++) {
+        if (sin_best.kernels && sin_best.kernels == GetBatchKernels((Isa) i)) {
+            sin_isa = (Isa) i;
+        }
+    }
+
+    FILE* file = fopen(options.output, "w");
+
+    if (!file) {
+        perror(options.output);
+        return false;
+    }
+
+    fprintf(file, "// Generated by autotune; rerun it rather than editing this file.\n");
+    fprintf(file, "// Budget: Sin/Cos %g LSB, Sqrtu %g relative, Tan %g relative\n", options.sin_max_error,
+            options.sqrt_max_error, options.tan_max_error);
+    fprintf(file, "// Inputs: %d-bit angles, numbers up to %u\n", angle_bits, options.sqrt_max);
+    fprintf(file, "//   Sin: %s, %.3f ns/element\n", sin_best.name.c_str(), sin_best_ns);
+    fprintf(file, "//   Sqrtu: %s, %.3f ns/element\n", IsaName(sqrt_best_isa), sqrt_best_ns);
+    fprintf(file, "//   Tan: %.3f ns/element\n\n", tan_best_ns);
+    fprintf(file, "#ifndef FIXED_POINT_MATH_TUNED_HPP\n#define FIXED_POINT_MATH_TUNED_HPP\n\n");
+    fprintf(file, "#include \"dispatch.hpp\"\n#include \"policy.hpp\"\n\n");
+    fprintf(file, "// The error bounds are the largest errors measured, not guarantees like those of the presets\n");
+    fprintf(file, "struct Tuned {\n");
+    fprintf(file, "    static constexpr SinTableKind sin_table_kind = SinTableKind::%s;\n",
+            sin_best.table == SinTableKind::coarse ? "coarse" : "fine");
+    fprintf(file, "    static constexpr int sin_interpolation_order = %d;\n", sin_best.interpolation_order);
+    fprintf(file, "    static constexpr double sin_max_error = %.6f;\n\n", sin_best_error);
+    fprintf(file, "    static constexpr int sqrt_tolerance_bits = %d;\n", sqrt_best_tolerance);
+    fprintf(file, "    static constexpr int sqrt_max_iterations = %d;\n", sqrt_best_iterations);
+    fprintf(file, "    static constexpr double sqrt_max_relative_error = %.9f;\n\n", sqrt_best_error);
+    fprintf(file, "    static constexpr int tan_newton_steps = %d;\n", tan_best_steps);
+    fprintf(file, "    static constexpr double tan_max_relative_error = %.9f;\n\n", tan_best_error);
+    fprintf(file, "    static constexpr double asin_max_error = %.2f;\n", Balanced::asin_max_error);
+    fprintf(file, "};\n\n");
+    fprintf(file, "// Whether arrays of angles are better off in SinBatch/CosBatch than in a loop over Sin<Tuned>\n");
+    fprintf(file, "constexpr bool TUNED_SIN_BATCH = %s;\n\n", sin_best.kernels ? "true" : "false");
+    fprintf(file, "// Fastest instruction sets, for GetBatchKernels(Isa) or FIXED_POINT_MATH_ISA\n");
+    fprintf(file, "constexpr Isa TUNED_SIN_ISA = Isa::%s;\n", IsaEnumName(sin_isa));
+    fprintf(file, "constexpr Isa TUNED_SQRT_ISA = Isa::%s;\n\n", IsaEnumName(sqrt_best_isa));
+    fprintf(file, "#endif\n");
+    fclose(file);
+
+    printf("Written to %s\n", options.output);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    Options options;
+
+    if (!ParseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    bool ok;
+
+    switch (options.angle_bits) {
+        case 12: ok = Tune<12>(options); break;
+        case 20: ok = Tune<20>(options); break;
+        case 24: ok = Tune<24>(options); break;
+        default: ok = Tune<16>(options); break;
+    }
+
+    return ok ? 0 : 1;
+}
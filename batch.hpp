@@ -0,0 +1,86 @@
+#ifndef FIXED_POINT_MATH_BATCH_HPP
+#define FIXED_POINT_MATH_BATCH_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dispatch.hpp"
+#include "sin_cos.hpp"
+
+// Array versions of Sqrtu, Log2floor, Log2ceil, Sin, Cos and SinDelta.
+// out[i] is bit-identical to calling the scalar function on input[i]. Input and output may be the same array.
+
+template <int TOLERANCE_BITS = 6, int MAX_ITERATIONS = 10>
+void SqrtuBatch(const uint32_t* numbers, uint32_t* out, size_t count) {
+    GetBatchKernels().sqrtu(numbers, out, count, TOLERANCE_BITS, MAX_ITERATIONS);
+}
+
+// Exact floor(sqrt(number)) for narrow inputs, much faster than SqrtuBatch: see SqrtFloorU8 and its siblings.
+// For SqrtBatchU24, every number must be below 2**24.
+inline void SqrtBatchU8(const uint8_t* numbers, uint8_t* out, size_t count) {
+    GetBatchKernels().sqrt_u8(numbers, out, count);
+}
+
+inline void SqrtBatchU16(const uint16_t* numbers, uint8_t* out, size_t count) {
+    GetBatchKernels().sqrt_u16(numbers, out, count);
+}
+
+inline void SqrtBatchU24(const uint32_t* numbers, uint16_t* out, size_t count) {
+    GetBatchKernels().sqrt_u24(numbers, out, count);
+}
+
+inline void Log2floorBatch(const uint32_t* values, int32_t* out, size_t count) {
+    GetBatchKernels().log2floor(values, out, count);
+}
+
+inline void Log2ceilBatch(const uint32_t* values, int32_t* out, size_t count) {
+    GetBatchKernels().log2ceil(values, out, count);
+}
+
+// The interpolation is done in 32-bit lanes, which limits angles to 30 bits
+constexpr int MAX_BATCH_ANGLE_BITS = 30;
+
+// SinKernel's delta * interp_pos + round, with the first step as the largest (give or take the rounding of the table)
+static_assert((((uint64_t) (sin_table[1] - sin_table[0]) + 1) << (MAX_BATCH_ANGLE_BITS - 2 - SIN_TABLE_BITS)) <=
+                      UINT32_MAX,
+              "the interpolation overflows 32 bits at MAX_BATCH_ANGLE_BITS");
+
+template <int angle_bits>
+void SinBatch(const int32_t* angles, int32_t* out, size_t count) {
+    static_assert(angle_bits >= SIN_TABLE_BITS + 2 && angle_bits <= MAX_BATCH_ANGLE_BITS, "angle_bits out of range");
+
+    GetBatchKernels().sin(angles, out, count, angle_bits);
+}
+
+template <int angle_bits>
+void CosBatch(const int32_t* angles, int32_t* out, size_t count) {
+    static_assert(angle_bits >= SIN_TABLE_BITS + 2 && angle_bits <= MAX_BATCH_ANGLE_BITS, "angle_bits out of range");
+
+    GetBatchKernels().cos(angles, out, count, angle_bits);
+}
+
+// Sin and Cos of int16_t angles into int16_t results; AVX2 and AVX-512 process 16 and 32 angles per instruction
+template <int angle_bits>
+void SinBatchI16(const int16_t* angles, int16_t* out, size_t count) {
+    static_assert(angle_bits >= SIN_TABLE_BITS + 2 && angle_bits <= 16, "angle_bits out of range");
+
+    GetBatchKernels().sin_i16(angles, out, count, angle_bits);
+}
+
+template <int angle_bits>
+void CosBatchI16(const int16_t* angles, int16_t* out, size_t count) {
+    static_assert(angle_bits >= SIN_TABLE_BITS + 2 && angle_bits <= 16, "angle_bits out of range");
+
+    GetBatchKernels().cos_i16(angles, out, count, angle_bits);
+}
+
+// SinBatch from sin_delta_table_v<SIN_TABLE_BITS>, reconstructing every value where it is needed, as SinDelta does:
+// nothing but the compressed table is read
+template <int angle_bits>
+void SinDeltaBatch(const int32_t* angles, int32_t* out, size_t count) {
+    static_assert(angle_bits >= SIN_TABLE_BITS + 2 && angle_bits <= MAX_BATCH_ANGLE_BITS, "angle_bits out of range");
+
+    GetBatchKernels().sin_delta(angles, out, count, angle_bits);
+}
+
+#endif
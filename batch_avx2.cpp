@@ -0,0 +1,166 @@
+// AVX2 batch kernels. This file is compiled with -mavx2.
+
+#include "batch_kernels.hpp"
+#include "simd_avx2.hpp"
+
+// Sin and Cos of int16_t angles in 16-bit lanes, 16 per instruction. The algorithm is SinKernel's, but the table is
+// looked up with pshufb and the rounded interpolation step is a single pmulhrsw.
+//
+// pshufb reads a 16-byte table, so sin_table is split into byte planes (low and high bytes of the values, and the
+// steps between them, which fit in a byte from SIN_TABLE_BITS = 5 up) of 16-entry chunks. Up to 4 chunks are
+// chained: chunk k is stored xor'd with chunk k - 1, and the control bytes drop by 16 from one chunk to the next, so
+// that once an index has been matched, the control has turned negative and pshufb contributes zeros from there on.
+// The xor of everything up to the matching chunk leaves exactly its entry.
+#if SIN_TABLE_BITS >= 5 && SIN_TABLE_BITS <= 6
+
+namespace {
+
+constexpr int num_chunks = (1 << SIN_TABLE_BITS) / 16;
+
+struct BytePlanes {
+    alignas(16) uint8_t low[num_chunks][16];
+    alignas(16) uint8_t high[num_chunks][16];
+    alignas(16) uint8_t step[num_chunks][16];
+};
+
+constexpr BytePlanes MakeBytePlanes() {
+    BytePlanes planes = {};
+
+    for (int i = 0; i < (1 << SIN_TABLE_BITS); i++) {
+        planes.low[i / 16][i % 16] = (uint8_t) (sin_table[i] & 0xff);
+        planes.high[i / 16][i % 16] = (uint8_t) (sin_table[i] >> 8);
+        planes.step[i / 16][i % 16] = (uint8_t) (sin_table[i + 1] - sin_table[i]);
+    }
+
+    // from the last chunk down, so that chunk k - 1 is still the plain one
+    for (int chunk = num_chunks - 1; chunk > 0; chunk--) {
+        for (int i = 0; i < 16; i++) {
+            planes.low[chunk][i] ^= planes.low[chunk - 1][i];
+            planes.high[chunk][i] ^= planes.high[chunk - 1][i];
+            planes.step[chunk][i] ^= planes.step[chunk - 1][i];
+        }
+    }
+
+    return planes;
+}
+
+constexpr BytePlanes byte_planes = MakeBytePlanes();
+
+struct Plane {
+    __m256i chunks[num_chunks];
+
+    explicit Plane(const uint8_t (&plane)[num_chunks][16]) {
+        for (int chunk = 0; chunk < num_chunks; chunk++) {
+            chunks[chunk] = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*) plane[chunk]));
+        }
+    }
+
+    // The byte selected by each control byte; `chunk_step` is 16 in the control bytes and 0 in the others
+    __m256i Lookup(__m256i control, __m256i chunk_step) const {
+        __m256i result = _mm256_shuffle_epi8(chunks[0], control);
+
+        for (int chunk = 1; chunk < num_chunks; chunk++) {
+            control = _mm256_sub_epi8(control, chunk_step);
+            result = _mm256_xor_si256(result, _mm256_shuffle_epi8(chunks[chunk], control));
+        }
+
+        return result;
+    }
+};
+
+struct SinI16Params {
+    Plane low{byte_planes.low};
+    Plane high{byte_planes.high};
+    Plane step{byte_planes.step};
+
+    __m128i interp_bits;
+    __m128i scale_bits;
+    __m256i interp_mask;
+    __m256i interp_max;
+    __m256i index_mask_v;
+    __m256i quarter_bit;
+    __m256i half_bit;
+    __m256i phase;
+
+    SinI16Params(int angle_bits, uint32_t phase)
+            : interp_bits(_mm_cvtsi32_si128(angle_bits - 2 - SIN_TABLE_BITS)),
+              scale_bits(_mm_cvtsi32_si128(15 - (angle_bits - 2 - SIN_TABLE_BITS))),
+              interp_mask(_mm256_set1_epi16((int16_t) ((1 << (angle_bits - 2 - SIN_TABLE_BITS)) - 1))),
+              interp_max(_mm256_set1_epi16((int16_t) (1 << (angle_bits - 2 - SIN_TABLE_BITS)))),
+              index_mask_v(_mm256_set1_epi16(index_mask)),
+              quarter_bit(_mm256_set1_epi16((int16_t) (1 << (angle_bits - 2)))),
+              half_bit(_mm256_set1_epi16((int16_t) (1 << (angle_bits - 1)))),
+              phase(_mm256_set1_epi16((int16_t) phase)) {
+    }
+};
+
+__m256i SinI16(__m256i bits, const SinI16Params& p) {
+    bits = _mm256_add_epi16(bits, p.phase);
+
+    __m256i index = _mm256_and_si256(_mm256_srl_epi16(bits, p.interp_bits), p.index_mask_v);
+    __m256i interp_pos = _mm256_and_si256(bits, p.interp_mask);
+
+    // 2nd or 4th quarter: mirror
+    __m256i mirror = _mm256_cmpeq_epi16(_mm256_and_si256(bits, p.quarter_bit), p.quarter_bit);
+    index = _mm256_xor_si256(index, _mm256_and_si256(mirror, p.index_mask_v));
+    interp_pos = _mm256_blendv_epi8(interp_pos, _mm256_sub_epi16(p.interp_max, interp_pos), mirror);
+
+    // control bytes for the low byte of each lane, and for the high byte; 0x80 selects a zero
+    __m256i control_low = _mm256_or_si256(index, _mm256_set1_epi16((int16_t) 0x8000));
+    __m256i control_high = _mm256_or_si256(_mm256_slli_epi16(index, 8), _mm256_set1_epi16(0x0080));
+    __m256i chunk_step_low = _mm256_set1_epi16(0x0010);
+    __m256i chunk_step_high = _mm256_set1_epi16(0x1000);
+
+    __m256i base = _mm256_or_si256(p.low.Lookup(control_low, chunk_step_low),
+                                   p.high.Lookup(control_high, chunk_step_high));
+    __m256i delta = p.step.Lookup(control_low, chunk_step_low);
+
+    // (delta interp_pos + round) >> interp_bits is pmulhrsw with interp_pos scaled to 15 fractional bits. At
+    // interp_pos = interp_max that scale wraps around to -2**15 and the product comes out as -delta, hence the abs.
+    __m256i step = _mm256_abs_epi16(_mm256_mulhrs_epi16(delta, _mm256_sll_epi16(interp_pos, p.scale_bits)));
+    __m256i interpolated = _mm256_add_epi16(base, step);
+
+    __m256i negate = _mm256_cmpeq_epi16(_mm256_and_si256(bits, p.half_bit), p.half_bit);
+    return _mm256_sub_epi16(_mm256_xor_si256(interpolated, negate), negate);
+}
+
+void SinI16Avx2(const int16_t* angles, int16_t* out, size_t count, int angle_bits, uint32_t phase) {
+    SinI16Params params(angle_bits, phase);
+    size_t i = 0;
+
+    for (; i + 16 <= count; i += 16) {
+        __m256i bits = _mm256_loadu_si256((const __m256i*) &angles[i]);
+        _mm256_storeu_si256((__m256i*) &out[i], SinI16(bits, params));
+    }
+
+    if (i < count) {
+        int16_t lanes[16] = {};
+        memcpy(lanes, &angles[i], (count - i) * sizeof(int16_t));
+
+        _mm256_storeu_si256((__m256i*) lanes, SinI16(_mm256_loadu_si256((const __m256i*) lanes), params));
+        memcpy(&out[i], lanes, (count - i) * sizeof(int16_t));
+    }
+}
+
+void SinI16Avx2(const int16_t* angles, int16_t* out, size_t count, int angle_bits) {
+    SinI16Avx2(angles, out, count, angle_bits, 0);
+}
+
+void CosI16Avx2(const int16_t* angles, int16_t* out, size_t count, int angle_bits) {
+    SinI16Avx2(angles, out, count, angle_bits, UINT32_C(1) << (angle_bits - 2));
+}
+
+}
+
+#endif
+
+extern const BatchKernels batch_kernels_avx2 = [] {
+    BatchKernels kernels = MakeBatchKernels<SimdAvx2>();
+
+#if SIN_TABLE_BITS >= 5 && SIN_TABLE_BITS <= 6
+    kernels.sin_i16 = SinI16Avx2;
+    kernels.cos_i16 = CosI16Avx2;
+#endif
+
+    return kernels;
+}();
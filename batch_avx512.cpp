@@ -0,0 +1,114 @@
+// AVX-512 batch kernels. This file is compiled with -mavx512{f,cd,bw,dq,vl}.
+
+#include "batch_kernels.hpp"
+#include "simd_avx512.hpp"
+
+// Sin and Cos of int16_t angles in 16-bit lanes, 32 per instruction, as in batch_avx2.cpp. Here a table of up to 64
+// words fits in two registers, where vpermi2w looks it up directly: one for the values and one for the steps.
+#if SIN_TABLE_BITS <= 6
+
+namespace {
+
+struct WordTables {
+    alignas(64) uint16_t base[64];
+    alignas(64) uint16_t step[64];
+};
+
+constexpr WordTables MakeWordTables() {
+    WordTables tables = {};
+
+    for (int i = 0; i < (1 << SIN_TABLE_BITS); i++) {
+        tables.base[i] = sin_table[i];
+        tables.step[i] = (uint16_t) (sin_table[i + 1] - sin_table[i]);
+    }
+
+    return tables;
+}
+
+constexpr WordTables word_tables = MakeWordTables();
+
+struct SinI16Params {
+    __m512i base_low = _mm512_load_si512(&word_tables.base[0]);
+    __m512i base_high = _mm512_load_si512(&word_tables.base[32]);
+    __m512i step_low = _mm512_load_si512(&word_tables.step[0]);
+    __m512i step_high = _mm512_load_si512(&word_tables.step[32]);
+
+    __m128i interp_bits;
+    __m128i scale_bits;
+    __m512i interp_mask;
+    __m512i interp_max;
+    __m512i index_mask_v;
+    __m512i quarter_bit;
+    __m512i half_bit;
+    __m512i phase;
+
+    SinI16Params(int angle_bits, uint32_t phase)
+            : interp_bits(_mm_cvtsi32_si128(angle_bits - 2 - SIN_TABLE_BITS)),
+              scale_bits(_mm_cvtsi32_si128(15 - (angle_bits - 2 - SIN_TABLE_BITS))),
+              interp_mask(_mm512_set1_epi16((int16_t) ((1 << (angle_bits - 2 - SIN_TABLE_BITS)) - 1))),
+              interp_max(_mm512_set1_epi16((int16_t) (1 << (angle_bits - 2 - SIN_TABLE_BITS)))),
+              index_mask_v(_mm512_set1_epi16(index_mask)),
+              quarter_bit(_mm512_set1_epi16((int16_t) (1 << (angle_bits - 2)))),
+              half_bit(_mm512_set1_epi16((int16_t) (1 << (angle_bits - 1)))),
+              phase(_mm512_set1_epi16((int16_t) phase)) {
+    }
+};
+
+__m512i SinI16(__m512i bits, const SinI16Params& p) {
+    bits = _mm512_add_epi16(bits, p.phase);
+
+    __m512i index = _mm512_and_si512(_mm512_srl_epi16(bits, p.interp_bits), p.index_mask_v);
+    __m512i interp_pos = _mm512_and_si512(bits, p.interp_mask);
+
+    // 2nd or 4th quarter: mirror
+    __mmask32 mirror = _mm512_test_epi16_mask(bits, p.quarter_bit);
+    index = _mm512_mask_sub_epi16(index, mirror, p.index_mask_v, index);
+    interp_pos = _mm512_mask_sub_epi16(interp_pos, mirror, p.interp_max, interp_pos);
+
+    __m512i base = _mm512_permutex2var_epi16(p.base_low, index, p.base_high);
+    __m512i delta = _mm512_permutex2var_epi16(p.step_low, index, p.step_high);
+
+    // pmulhrsw, with the same wrap-around at interp_pos = interp_max as in batch_avx2.cpp
+    __m512i step = _mm512_abs_epi16(_mm512_mulhrs_epi16(delta, _mm512_sll_epi16(interp_pos, p.scale_bits)));
+    __m512i interpolated = _mm512_add_epi16(base, step);
+
+    __mmask32 negate = _mm512_test_epi16_mask(bits, p.half_bit);
+    return _mm512_mask_sub_epi16(interpolated, negate, _mm512_setzero_si512(), interpolated);
+}
+
+void SinI16Avx512(const int16_t* angles, int16_t* out, size_t count, int angle_bits, uint32_t phase) {
+    SinI16Params params(angle_bits, phase);
+    size_t i = 0;
+
+    for (; i + 32 <= count; i += 32) {
+        _mm512_storeu_si512(&out[i], SinI16(_mm512_loadu_si512(&angles[i]), params));
+    }
+
+    if (i < count) {
+        __mmask32 lanes = (__mmask32) ((UINT64_C(1) << (count - i)) - 1);
+        _mm512_mask_storeu_epi16(&out[i], lanes, SinI16(_mm512_maskz_loadu_epi16(lanes, &angles[i]), params));
+    }
+}
+
+void SinI16Avx512(const int16_t* angles, int16_t* out, size_t count, int angle_bits) {
+    SinI16Avx512(angles, out, count, angle_bits, 0);
+}
+
+void CosI16Avx512(const int16_t* angles, int16_t* out, size_t count, int angle_bits) {
+    SinI16Avx512(angles, out, count, angle_bits, UINT32_C(1) << (angle_bits - 2));
+}
+
+}
+
+#endif
+
+extern const BatchKernels batch_kernels_avx512 = [] {
+    BatchKernels kernels = MakeBatchKernels<SimdAvx512>();
+
+#if SIN_TABLE_BITS <= 6
+    kernels.sin_i16 = SinI16Avx512;
+    kernels.cos_i16 = CosI16Avx512;
+#endif
+
+    return kernels;
+}();
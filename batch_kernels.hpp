@@ -0,0 +1,561 @@
+#ifndef FIXED_POINT_MATH_BATCH_KERNELS_HPP
+#define FIXED_POINT_MATH_BATCH_KERNELS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "dispatch.hpp"
+#include "sin_cos.hpp"
+
+// Batch kernels, written once against a SIMD backend `V` with 32-bit lanes. A few operations treat every lane as two
+// 16-bit elements, or every two lanes as one 64-bit lane.
+//
+// A backend provides `width`, the types `Vec`, `Mask` and `PairTable`, and the operations documented in
+// simd_emulated.hpp. Each backend header must be included by exactly one source file, compiled with the matching
+// instruction set flags. Everything here is templated on the backend, so no code compiled for one instruction set
+// can end up being called on a CPU that only supports another.
+
+// Apply `func` to whole vectors, then to the zero-padded remainder
+template <typename V, typename In_t, typename Out_t, typename Func>
+void MapKernel(const In_t* in, Out_t* out, size_t count, Func func) {
+    static_assert(sizeof(In_t) == 4 && sizeof(Out_t) == 4, "32-bit lanes expected");
+
+    size_t i = 0;
+
+    for (; i + V::width <= count; i += V::width) {
+        V::Store(&out[i], func(V::Load(&in[i])));
+    }
+
+    if (i < count) {
+        V::StorePartial(&out[i], func(V::LoadPartial(&in[i], count - i)), count - i);
+    }
+}
+
+// MapKernel for inputs and outputs narrower than the lanes, widened and narrowed a block at a time
+template <typename V, typename In_t, typename Out_t, typename Func>
+void MapWidenedKernel(const In_t* in, Out_t* out, size_t count, Func func) {
+    constexpr size_t block_size = 256;
+    uint32_t wide[block_size];
+
+    for (size_t begin = 0; begin < count; begin += block_size) {
+        size_t block_count = (count - begin < block_size) ? count - begin : block_size;
+
+        for (size_t i = 0; i < block_count; i++) {
+            wide[i] = (uint32_t) in[begin + i];
+        }
+
+        MapKernel<V>(wide, wide, block_count, func);
+
+        for (size_t i = 0; i < block_count; i++) {
+            out[begin + i] = (Out_t) wide[i];
+        }
+    }
+}
+
+template <typename V>
+typename V::Vec Log2floorKernel(typename V::Vec v) {
+    // 31 - 32 = -1 for 0
+    return V::Sub(V::Set1(31), V::Clz(v));
+}
+
+template <typename V>
+typename V::Vec Log2ceilKernel(typename V::Vec v) {
+    auto r = V::Sub(V::Set1(32), V::Clz(V::Sub(v, V::Set1(1))));
+    return V::Select(V::CmpEq(v, V::Set1(0)), V::Set1(-1), r);
+}
+
+// Same algorithm as Sqrtu<TOLERANCE_BITS, MAX_ITERATIONS>, all lanes in lockstep
+template <typename V>
+typename V::Vec SqrtuKernel(typename V::Vec number, int tolerance_bits, int max_iterations) {
+    auto magn = V::MaxS(Log2floorKernel<V>(number), V::Set1(0));
+    auto lower = V::Pow2(V::ShiftRight(magn, 1));
+    auto upper = V::Add(lower, lower);
+    auto tol = V::Add(V::ShiftRight(lower, tolerance_bits), V::Set1(1));
+
+    // once a lane is within tolerance it stays there, as the interval only shrinks
+    auto active = V::CmpGtU(V::Sub(upper, lower), tol);
+
+    for (int num_iterations = 0; num_iterations < max_iterations && V::Any(active); num_iterations++) {
+        auto guess = V::ShiftRight(V::Add(lower, upper), 1);
+        auto too_big = V::CmpGtU(V::MulLo(guess, guess), number);
+
+        upper = V::Select(V::MaskAnd(active, too_big), guess, upper);
+        lower = V::Select(V::MaskAndNot(active, too_big), guess, lower);
+        active = V::MaskAnd(active, V::CmpGtU(V::Sub(upper, lower), tol));
+    }
+
+    auto result = V::ShiftRight(V::Add(lower, upper), 1);
+    return V::Select(V::CmpEq(number, V::Set1(0)), V::Set1(0), result);
+}
+
+// Everything SinKernel needs to know about the angles
+template <typename V>
+struct SinAngleParams {
+    int interp_bits;
+    typename V::Vec interp_mask;
+    typename V::Vec interp_max;
+    typename V::Vec round;
+    typename V::Vec half_bit;
+    typename V::Vec quarter_bit;
+    typename V::Vec phase;
+
+    // `phase` is added to every angle: 0 for sine, a quarter turn for cosine
+    SinAngleParams(int angle_bits, uint32_t phase)
+            : interp_bits(angle_bits - 2 - SIN_TABLE_BITS),
+              interp_mask(V::Set1((UINT32_C(1) << interp_bits) - 1)),
+              interp_max(V::Set1(UINT32_C(1) << interp_bits)),
+              round(V::Set1((UINT32_C(1) << interp_bits) / 2)),
+              half_bit(V::Set1(UINT32_C(1) << (angle_bits - 1))),
+              quarter_bit(V::Set1(UINT32_C(1) << (angle_bits - 2))),
+              phase(V::Set1(phase)) {
+    }
+};
+
+template <typename V>
+struct SinKernelParams : SinAngleParams<V> {
+    typename V::PairTable table;
+
+    SinKernelParams(int angle_bits, uint32_t phase)
+            : SinAngleParams<V>(angle_bits, phase),
+              table(sin_table, 1 << SIN_TABLE_BITS) {
+    }
+};
+
+// Same algorithm as Sin<angle_bits, Angle_t>, with `lookup(index, base, delta)` reading the table
+template <typename V, typename Lookup>
+typename V::Vec SinKernel(typename V::Vec bits, const SinAngleParams<V>& p, Lookup lookup) {
+    bits = V::Add(bits, p.phase);
+
+    auto index = V::And(V::ShiftRight(bits, p.interp_bits), V::Set1(index_mask));
+    auto interp_pos = V::And(bits, p.interp_mask);
+
+    // 2nd or 4th quarter: mirror
+    auto mirror = V::Test(bits, p.quarter_bit);
+    index = V::Select(mirror, V::Xor(index, V::Set1(index_mask)), index);
+    interp_pos = V::Select(mirror, V::Sub(p.interp_max, interp_pos), interp_pos);
+
+    typename V::Vec base, delta;
+    lookup(index, base, delta);
+
+    auto step = V::Add(V::MulLo(delta, interp_pos), p.round);
+    auto interpolated = V::Add(base, V::ShiftRight(step, p.interp_bits));
+
+    return V::Select(V::Test(bits, p.half_bit), V::Sub(V::Set1(0), interpolated), interpolated);
+}
+
+template <typename V>
+typename V::Vec SinKernel(typename V::Vec bits, const SinKernelParams<V>& p) {
+    return SinKernel<V>(bits, p, [&p](typename V::Vec index, typename V::Vec& base, typename V::Vec& delta) {
+        auto pairs = V::LookupPairs(p.table, index);
+        base = V::And(pairs, V::Set1(0xffff));
+        delta = V::Sub(V::ShiftRight(pairs, 16), base);
+    });
+}
+
+// values[index] and steps[index] of sin_delta_table_v<SIN_TABLE_BITS>, as SinDeltaLookup finds them. Each lane
+// gathers the aligned group of 8 steps around its index as two words and its block's base, keeps the steps before
+// its position and adds those up pairwise; the step at the position is shifted down with uniform shifts.
+template <typename V>
+void SinDeltaLookupKernel(typename V::Vec index, typename V::Vec& value, typename V::Vec& step) {
+    using Table = SinDeltaTable<SIN_TABLE_BITS>;
+    constexpr uint32_t block_mask = (1 << SIN_DELTA_BLOCK_BITS) - 1;
+
+    static_assert(block_mask == 7, "one group of steps per two 32-bit words");
+    static_assert(offsetof(Table, steps) == 0 && offsetof(Table, bases) == Table::num_steps, "unexpected layout");
+
+    const auto& table = sin_delta_table_v<SIN_TABLE_BITS>;
+    auto group = V::And(index, V::Set1(~block_mask));
+    auto low = V::Gather(&table, group);
+    auto high = V::Gather(&table, V::Add(group, V::Set1(4)));
+
+    // the base ends the word before it, so that the last one is not read past the end of the table
+    auto base_offset = V::Add(V::And(V::ShiftRight(index, SIN_DELTA_BLOCK_BITS - 1), V::Set1(~UINT32_C(1))),
+                              V::Set1(Table::num_steps - 2));
+    auto base = V::ShiftRight(V::Gather(&table, base_offset), 16);
+
+    // steps before the position: those of the low word below it, or all of the low word and those of the high one
+    auto position = V::And(index, V::Set1(block_mask));
+    auto in_high = V::Test(position, V::Set1(4));
+    auto below = V::Sub(V::Pow2(V::MulLo(V::And(position, V::Set1(3)), V::Set1(8))), V::Set1(1));
+    auto before_low = V::Select(in_high, low, V::And(low, below));
+    auto before_high = V::Select(in_high, V::And(high, below), V::Set1(0));
+
+    // at most 8 steps below 2**8, so the 16-bit halves of the pair sums and their total cannot overflow
+    auto low_bytes = V::Set1(0x00ff00ff);
+    auto pairs = V::Add(V::Add(V::And(before_low, low_bytes), V::And(V::ShiftRight(before_low, 8), low_bytes)),
+                        V::Add(V::And(before_high, low_bytes), V::And(V::ShiftRight(before_high, 8), low_bytes)));
+    value = V::Add(base, V::ShiftRight(V::MulLo(pairs, V::Set1(0x00010001)), 16));
+
+    auto word = V::Select(in_high, high, low);
+    word = V::Select(V::Test(position, V::Set1(2)), V::ShiftRight(word, 16), word);
+    word = V::Select(V::Test(position, V::Set1(1)), V::ShiftRight(word, 8), word);
+    step = V::And(word, V::Set1(0xff));
+}
+
+// x a + y b with a and b in Q12, rounded like RotateX/RotateY, but in 32-bit lanes: with x = xh 2**12 + xl and
+// 0 <= xl < 2**12, x a = (xh a) 2**12 + xl a, so only the low parts take part in the rounding. The high parts are
+// summed modulo 2**32, which is exact whenever the result fits.
+template <typename V>
+typename V::Vec MulAddRound12Kernel(typename V::Vec x, typename V::Vec a, typename V::Vec y, typename V::Vec b) {
+    // arithmetic shift right by 12, by way of a logical one
+    auto sign = V::Set1(UINT32_C(1) << 31);
+    auto xh = V::Sub(V::ShiftRight(V::Xor(x, sign), 12), V::Set1(UINT32_C(1) << 19));
+    auto yh = V::Sub(V::ShiftRight(V::Xor(y, sign), 12), V::Set1(UINT32_C(1) << 19));
+    auto xl = V::And(x, V::Set1(0xfff));
+    auto yl = V::And(y, V::Set1(0xfff));
+
+    // |xl a + yl b| < 2**26; bias it to be positive for the logical shift, then take the bias back out
+    auto low = V::Add(V::Add(V::MulLo(xl, a), V::MulLo(yl, b)), V::Set1((UINT32_C(1) << 26) + 2048));
+    auto high = V::Add(V::MulLo(xh, a), V::MulLo(yh, b));
+
+    return V::Add(high, V::Sub(V::ShiftRight(low, 12), V::Set1(UINT32_C(1) << 14)));
+}
+
+template <typename V>
+void Rotate2DKernel(typename V::Vec x, typename V::Vec y, typename V::Vec cos, typename V::Vec sin,
+                    typename V::Vec& out_x, typename V::Vec& out_y) {
+    out_x = MulAddRound12Kernel<V>(x, cos, y, V::Sub(V::Set1(0), sin));
+    out_y = MulAddRound12Kernel<V>(x, sin, y, cos);
+}
+
+template <typename V>
+void SqrtuBatchKernel(const uint32_t* numbers, uint32_t* out, size_t count, int tolerance_bits, int max_iterations) {
+    MapKernel<V>(numbers, out, count, [=](typename V::Vec v) {
+        return SqrtuKernel<V>(v, tolerance_bits, max_iterations);
+    });
+}
+
+template <typename V>
+void SqrtU8BatchKernel(const uint8_t* numbers, uint8_t* out, size_t count) {
+    MapWidenedKernel<V>(numbers, out, count, [](typename V::Vec v) { return V::SqrtFloat(v); });
+}
+
+template <typename V>
+void SqrtU16BatchKernel(const uint16_t* numbers, uint8_t* out, size_t count) {
+    MapWidenedKernel<V>(numbers, out, count, [](typename V::Vec v) { return V::SqrtFloat(v); });
+}
+
+template <typename V>
+void SqrtU24BatchKernel(const uint32_t* numbers, uint16_t* out, size_t count) {
+    MapWidenedKernel<V>(numbers, out, count, [](typename V::Vec v) { return V::SqrtFloat(v); });
+}
+
+template <typename V>
+void Log2floorBatchKernel(const uint32_t* values, int32_t* out, size_t count) {
+    MapKernel<V>(values, out, count, [](typename V::Vec v) { return Log2floorKernel<V>(v); });
+}
+
+template <typename V>
+void Log2ceilBatchKernel(const uint32_t* values, int32_t* out, size_t count) {
+    MapKernel<V>(values, out, count, [](typename V::Vec v) { return Log2ceilKernel<V>(v); });
+}
+
+template <typename V>
+void SinBatchKernel(const int32_t* angles, int32_t* out, size_t count, int angle_bits) {
+    SinKernelParams<V> params(angle_bits, 0);
+    MapKernel<V>(angles, out, count, [&](typename V::Vec v) { return SinKernel<V>(v, params); });
+}
+
+template <typename V>
+void CosBatchKernel(const int32_t* angles, int32_t* out, size_t count, int angle_bits) {
+    SinKernelParams<V> params(angle_bits, UINT32_C(1) << (angle_bits - 2));
+    MapKernel<V>(angles, out, count, [&](typename V::Vec v) { return SinKernel<V>(v, params); });
+}
+
+template <typename V>
+void SinDeltaBatchKernel(const int32_t* angles, int32_t* out, size_t count, int angle_bits) {
+    SinAngleParams<V> params(angle_bits, 0);
+
+    MapKernel<V>(angles, out, count, [&](typename V::Vec v) {
+        return SinKernel<V>(v, params, SinDeltaLookupKernel<V>);
+    });
+}
+
+// int16_t angles through SinKernel in 32-bit lanes. batch_avx2.cpp and batch_avx512.cpp replace this with kernels
+// that work in 16-bit lanes throughout.
+template <typename V>
+void SinI16BatchKernel(const int16_t* angles, int16_t* out, size_t count, int angle_bits, uint32_t phase) {
+    SinKernelParams<V> params(angle_bits, phase);
+    MapWidenedKernel<V>(angles, out, count, [&](typename V::Vec v) { return SinKernel<V>(v, params); });
+}
+
+template <typename V>
+void SinI16BatchKernel(const int16_t* angles, int16_t* out, size_t count, int angle_bits) {
+    SinI16BatchKernel<V>(angles, out, count, angle_bits, 0);
+}
+
+template <typename V>
+void CosI16BatchKernel(const int16_t* angles, int16_t* out, size_t count, int angle_bits) {
+    SinI16BatchKernel<V>(angles, out, count, angle_bits, UINT32_C(1) << (angle_bits - 2));
+}
+
+template <typename V>
+void Rotate2DBatchKernel(const int32_t* xs, const int32_t* ys, int32_t* out_x, int32_t* out_y, size_t count,
+                         int32_t cos, int32_t sin) {
+    auto cos_v = V::Set1(cos);
+    auto sin_v = V::Set1(sin);
+    typename V::Vec rx, ry;
+    size_t i = 0;
+
+    for (; i + V::width <= count; i += V::width) {
+        Rotate2DKernel<V>(V::Load(&xs[i]), V::Load(&ys[i]), cos_v, sin_v, rx, ry);
+        V::Store(&out_x[i], rx);
+        V::Store(&out_y[i], ry);
+    }
+
+    if (i < count) {
+        Rotate2DKernel<V>(V::LoadPartial(&xs[i], count - i), V::LoadPartial(&ys[i], count - i), cos_v, sin_v, rx, ry);
+        V::StorePartial(&out_x[i], rx, count - i);
+        V::StorePartial(&out_y[i], ry, count - i);
+    }
+}
+
+template <typename V>
+void Rotate2DPerPointBatchKernel(const int32_t* xs, const int32_t* ys, const int32_t* angles, int32_t* out_x,
+                                 int32_t* out_y, size_t count, int angle_bits) {
+    SinKernelParams<V> sin_params(angle_bits, 0);
+    SinKernelParams<V> cos_params(angle_bits, UINT32_C(1) << (angle_bits - 2));
+    typename V::Vec rx, ry;
+    size_t i = 0;
+
+    for (; i + V::width <= count; i += V::width) {
+        auto angle = V::Load(&angles[i]);
+        Rotate2DKernel<V>(V::Load(&xs[i]), V::Load(&ys[i]), SinKernel<V>(angle, cos_params),
+                          SinKernel<V>(angle, sin_params), rx, ry);
+        V::Store(&out_x[i], rx);
+        V::Store(&out_y[i], ry);
+    }
+
+    if (i < count) {
+        auto angle = V::LoadPartial(&angles[i], count - i);
+        Rotate2DKernel<V>(V::LoadPartial(&xs[i], count - i), V::LoadPartial(&ys[i], count - i),
+                          SinKernel<V>(angle, cos_params), SinKernel<V>(angle, sin_params), rx, ry);
+        V::StorePartial(&out_x[i], rx, count - i);
+        V::StorePartial(&out_y[i], ry, count - i);
+    }
+}
+
+// Lane k starts k samples ahead: at phase + k step + k (k - 1) / 2 step_delta, with a step of step + k step_delta.
+// A vector then advances by width samples at once, everything modulo 2**32 just like the scalar accumulator.
+template <typename V>
+void SinSweepBatchKernel(int32_t* out, size_t count, uint32_t phase, uint32_t step, uint32_t step_delta,
+                         int angle_bits) {
+    static_assert(V::width <= 16, "lane tables too short");
+
+    static const uint32_t lane_index[16] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+    static const uint32_t lane_triangle[16] = {0, 0, 1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 66, 78, 91, 105};
+    constexpr uint32_t width = V::width;
+
+    SinKernelParams<V> params(angle_bits, 0);
+    const int shift = 32 - angle_bits;
+
+    auto lane = V::Load(lane_index);
+    auto lane_phase = V::Add(V::Set1(phase), V::Add(V::MulLo(lane, V::Set1(step)),
+                                                    V::MulLo(V::Load(lane_triangle), V::Set1(step_delta))));
+    auto lane_step = V::Add(V::Set1(step), V::MulLo(lane, V::Set1(step_delta)));
+
+    // over width samples, every lane's step grows by width step_delta and its phase by
+    // width step + width (width - 1) / 2 step_delta
+    auto step_growth = V::Set1(width * step_delta);
+    auto phase_growth = V::Set1(width * (width - 1) / 2 * step_delta);
+    auto width_v = V::Set1(width);
+    size_t i = 0;
+
+    for (; i + width <= count; i += width) {
+        V::Store(&out[i], SinKernel<V>(V::ShiftRight(lane_phase, shift), params));
+
+        lane_phase = V::Add(lane_phase, V::Add(V::MulLo(lane_step, width_v), phase_growth));
+        lane_step = V::Add(lane_step, step_growth);
+    }
+
+    if (i < count) {
+        V::StorePartial(&out[i], SinKernel<V>(V::ShiftRight(lane_phase, shift), params), count - i);
+    }
+}
+
+// The first `count` elements at `in`, zero-padded to a whole vector; for elements narrower than the lanes
+template <typename V, typename T>
+typename V::Vec LoadPartialElements(const T* in, size_t count) {
+    uint32_t lanes[V::width] = {};
+    memcpy(lanes, in, count * sizeof(T));
+    return V::Load(lanes);
+}
+
+template <typename V, typename T>
+void StorePartialElements(T* out, typename V::Vec v, size_t count) {
+    uint32_t lanes[V::width];
+    V::Store(lanes, v);
+    memcpy(out, lanes, count * sizeof(T));
+}
+
+// Apply `func` to whole vectors of `a` and `b`, then to the zero-padded remainder. Elements of 16 bits go two to a
+// lane.
+template <typename V, typename T, typename Func>
+void MapBinaryKernel(const T* a, const T* b, T* out, size_t count, Func func) {
+    constexpr size_t per_vector = V::width * sizeof(uint32_t) / sizeof(T);
+    size_t i = 0;
+
+    for (; i + per_vector <= count; i += per_vector) {
+        V::Store(&out[i], func(V::Load(&a[i]), V::Load(&b[i])));
+    }
+
+    if (i < count) {
+        auto result = func(LoadPartialElements<V>(&a[i], count - i), LoadPartialElements<V>(&b[i], count - i));
+        StorePartialElements<V>(&out[i], result, count - i);
+    }
+}
+
+// Sum of the 64-bit lanes of `func(a, b)` over whole vectors and the zero-padded remainder, modulo 2**64.
+// `num_vectors` is set to the number of vectors that went into the sum.
+template <typename V, typename T, typename Func>
+uint64_t SumBinaryKernel(const T* a, const T* b, size_t count, size_t& num_vectors, Func func) {
+    constexpr size_t per_vector = V::width * sizeof(uint32_t) / sizeof(T);
+    auto sum = V::Set1(0);
+    size_t i = 0;
+
+    for (; i + per_vector <= count; i += per_vector) {
+        sum = V::Add64(sum, func(V::Load(&a[i]), V::Load(&b[i])));
+    }
+
+    if (i < count) {
+        sum = V::Add64(sum, func(LoadPartialElements<V>(&a[i], count - i), LoadPartialElements<V>(&b[i], count - i)));
+    }
+
+    num_vectors = (count + per_vector - 1) / per_vector;
+
+    uint64_t lanes[V::width / 2];
+    V::Store(lanes, sum);
+
+    uint64_t total = 0;
+
+    for (auto lane : lanes) {
+        total += lane;
+    }
+
+    return total;
+}
+
+// Where the sign bit of `overflow` is set, INT32_MAX or INT32_MIN according to the sign of `a`, else `result`
+template <typename V>
+typename V::Vec SaturateOnOverflow32(typename V::Vec result, typename V::Vec a, typename V::Vec overflow) {
+    auto saturated = V::Add(V::Set1(INT32_MAX), V::ShiftRight(a, 31));
+    return V::Select(V::Test(overflow, V::Set1(UINT32_C(1) << 31)), saturated, result);
+}
+
+template <typename V>
+void AddSat16BatchKernel(const int16_t* a, const int16_t* b, int16_t* out, size_t count) {
+    MapBinaryKernel<V>(a, b, out, count, [](typename V::Vec va, typename V::Vec vb) { return V::AddSat16(va, vb); });
+}
+
+template <typename V>
+void SubSat16BatchKernel(const int16_t* a, const int16_t* b, int16_t* out, size_t count) {
+    MapBinaryKernel<V>(a, b, out, count, [](typename V::Vec va, typename V::Vec vb) { return V::SubSat16(va, vb); });
+}
+
+template <typename V>
+void AddSat32BatchKernel(const int32_t* a, const int32_t* b, int32_t* out, size_t count) {
+    MapBinaryKernel<V>(a, b, out, count, [](typename V::Vec va, typename V::Vec vb) {
+        auto sum = V::Add(va, vb);
+        // overflow iff both operands have the same sign and the sum has the other one
+        return SaturateOnOverflow32<V>(sum, va, V::And(V::Xor(va, sum), V::Xor(vb, sum)));
+    });
+}
+
+template <typename V>
+void SubSat32BatchKernel(const int32_t* a, const int32_t* b, int32_t* out, size_t count) {
+    MapBinaryKernel<V>(a, b, out, count, [](typename V::Vec va, typename V::Vec vb) {
+        auto diff = V::Sub(va, vb);
+        // overflow iff the operands have different signs and the difference has the sign of `b`
+        return SaturateOnOverflow32<V>(diff, va, V::And(V::Xor(va, vb), V::Xor(va, diff)));
+    });
+}
+
+template <typename V>
+void MulhRound15BatchKernel(const int16_t* a, const int16_t* b, int16_t* out, size_t count) {
+    auto min = V::Set1(0x80008000);
+
+    MapBinaryKernel<V>(a, b, out, count, [=](typename V::Vec va, typename V::Vec vb) {
+        // MulhRound16 wraps -1 * -1 to INT16_MIN; flip it to INT16_MAX
+        auto both_min = V::And(V::CmpEq16(va, min), V::CmpEq16(vb, min));
+        return V::Xor(V::MulhRound16(va, vb), both_min);
+    });
+}
+
+template <typename V>
+void MulhRound31BatchKernel(const int32_t* a, const int32_t* b, int32_t* out, size_t count) {
+    // in 64-bit lanes: 2**30, and the low half
+    auto round = V::ShiftRight64(V::Set1(UINT32_C(1) << 30), 32);
+    auto low_half = V::ShiftRight64(V::Set1(0xffffffff), 32);
+    auto min = V::Set1(UINT32_C(1) << 31);
+
+    MapBinaryKernel<V>(a, b, out, count, [=](typename V::Vec va, typename V::Vec vb) {
+        // bits 31..62 of the rounded products of the even and the odd lanes
+        auto even = V::ShiftRight64(V::Add64(V::MulEven32(va, vb), round), 31);
+        auto odd = V::MulEven32(V::ShiftRight64(va, 32), V::ShiftRight64(vb, 32));
+        odd = V::ShiftLeft64(V::ShiftRight64(V::Add64(odd, round), 31), 32);
+
+        // -1 * -1 wraps to INT32_MIN as well
+        auto both_min = V::MaskAnd(V::CmpEq(va, min), V::CmpEq(vb, min));
+        return V::Select(both_min, V::Set1(INT32_MAX), V::Xor(V::And(even, low_half), odd));
+    });
+}
+
+// MaddPairs16 only wraps for 2**31, so every pair sum is in (-2**31, 2**31]: biased by 2**31 - 1, it is exact as an
+// unsigned 32-bit number, and both halves of a 64-bit lane can be added up zero-extended. The bias of every lane is
+// taken back out at the end.
+template <typename V>
+int64_t MacQ15BatchKernel(int64_t acc, const int16_t* a, const int16_t* b, size_t count) {
+    auto bias = V::Set1(INT32_MAX);
+    auto low_half = V::ShiftRight64(V::Set1(0xffffffff), 32);
+    size_t num_vectors;
+
+    uint64_t sum = SumBinaryKernel<V>(a, b, count, num_vectors, [=](typename V::Vec va, typename V::Vec vb) {
+        auto pairs = V::Add(V::MaddPairs16(va, vb), bias);
+        return V::Add64(V::And(pairs, low_half), V::ShiftRight64(pairs, 32));
+    });
+
+    return (int64_t) ((uint64_t) acc + sum - (uint64_t) num_vectors * V::width * INT32_MAX);
+}
+
+template <typename V>
+int64_t MacQ31BatchKernel(int64_t acc, const int32_t* a, const int32_t* b, size_t count) {
+    size_t num_vectors;
+
+    uint64_t sum = SumBinaryKernel<V>(a, b, count, num_vectors, [](typename V::Vec va, typename V::Vec vb) {
+        auto odd = V::MulEven32(V::ShiftRight64(va, 32), V::ShiftRight64(vb, 32));
+        return V::Add64(V::MulEven32(va, vb), odd);
+    });
+
+    return (int64_t) ((uint64_t) acc + sum);
+}
+
+template <typename V>
+constexpr BatchKernels MakeBatchKernels() {
+    return {
+            SqrtuBatchKernel<V>,
+            Log2floorBatchKernel<V>,
+            Log2ceilBatchKernel<V>,
+            SinBatchKernel<V>,
+            CosBatchKernel<V>,
+            Rotate2DBatchKernel<V>,
+            Rotate2DPerPointBatchKernel<V>,
+            SinSweepBatchKernel<V>,
+            SinDeltaBatchKernel<V>,
+            SinI16BatchKernel<V>,
+            CosI16BatchKernel<V>,
+            SqrtU8BatchKernel<V>,
+            SqrtU16BatchKernel<V>,
+            SqrtU24BatchKernel<V>,
+            AddSat16BatchKernel<V>,
+            SubSat16BatchKernel<V>,
+            AddSat32BatchKernel<V>,
+            SubSat32BatchKernel<V>,
+            MulhRound15BatchKernel<V>,
+            MulhRound31BatchKernel<V>,
+            MacQ15BatchKernel<V>,
+            MacQ31BatchKernel<V>,
+    };
+}
+
+#endif
@@ -0,0 +1,7 @@
+// Portable batch kernels; the reference every other instruction set is tested against. They are the kernel
+// templates themselves, on the plain C++ backend, so that they cannot drift apart from the vectorized ones.
+
+#include "batch_kernels.hpp"
+#include "simd_emulated.hpp"
+
+extern const BatchKernels batch_kernels_scalar = MakeBatchKernels<SimdEmulated>();
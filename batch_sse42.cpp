@@ -0,0 +1,6 @@
+// SSE4.2 batch kernels. This file is compiled with -msse4.2.
+
+#include "batch_kernels.hpp"
+#include "simd_sse42.hpp"
+
+extern const BatchKernels batch_kernels_sse42 = MakeBatchKernels<SimdSse42>();
@@ -0,0 +1,432 @@
+// Micro-benchmarks. Not a test: build the `bench` target in Release mode and run it by hand.
+// With --counters, hardware event counters are read around every run as well, see bench_counters.hpp.
+
+#include "asin_acos.hpp"
+#include "bench_counters.hpp"
+#include "dds.hpp"
+#include "dispatch.hpp"
+#include "fft.hpp"
+#include "instrument.hpp"
+#include "parallel.hpp"
+#include "policy.hpp"
+#include "rotate.hpp"
+#include "sin_cos.hpp"
+#include "tan.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+constexpr size_t NUM_INPUTS = 1 << 16;
+constexpr int NUM_REPEATS = 200;
+
+static volatile int64_t sink;
+
+// nullptr: timing only
+static PerfCounters* perf_counters;
+
+static uint32_t Xorshift32(uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+template <typename T>
+static std::vector<T> RandomInputs(uint32_t mask) {
+    std::vector<T> inputs(NUM_INPUTS);
+    uint32_t state = 0x12345678;
+
+    for (auto& input : inputs) {
+        input = (T) (Xorshift32(state) & mask);
+    }
+
+    return inputs;
+}
+
+static void StartCounters() {
+    if (perf_counters) {
+        perf_counters->Start();
+    }
+}
+
+// Nothing valid when timing only
+static PerfCounters::Sample StopCounters() {
+    return perf_counters ? perf_counters->Stop() : PerfCounters::Sample{};
+}
+
+// Prints the time and, if counted, instructions, IPC and misses, all per call or element
+static void PrintResult(const char* name, double ns, double count, const char* unit,
+                        const PerfCounters::Sample& sample) {
+    printf("%-40s %8.3f ns/%s", name, ns / count, unit);
+
+    if (sample.valid[PerfCounters::instructions]) {
+        printf("  %8.2f instructions/%s", (double) sample.values[PerfCounters::instructions] / count, unit);
+
+        if (sample.values[PerfCounters::cycles] != 0) {
+            printf("  %5.2f IPC", (double) sample.values[PerfCounters::instructions] /
+                                  (double) sample.values[PerfCounters::cycles]);
+        }
+    }
+
+    if (sample.valid[PerfCounters::branch_misses]) {
+        printf("  %8.4f branch-misses/%s", (double) sample.values[PerfCounters::branch_misses] / count, unit);
+    }
+
+    if (sample.valid[PerfCounters::l1d_misses]) {
+        printf("  %8.4f L1D-misses/%s", (double) sample.values[PerfCounters::l1d_misses] / count, unit);
+    }
+
+    printf("\n");
+}
+
+// Calls func on every input NUM_REPEATS times and prints the average time per call. The counters stop together with
+// the clock, so that neither the clock nor the printing is counted. Returns the instructions per call, or NAN if they
+// were not counted.
+template <typename T, typename Func>
+static double Run(const char* name, const std::vector<T>& inputs, Func func) {
+    int64_t sum = 0;
+
+    StartCounters();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int repeat = 0; repeat < NUM_REPEATS; repeat++) {
+        for (auto input : inputs) {
+            sum += func(input);
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    auto sample = StopCounters();
+    sink = sum;
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    double count = (double) inputs.size() * NUM_REPEATS;
+    PrintResult(name, ns, count, "call", sample);
+
+    return sample.valid[PerfCounters::instructions] ? (double) sample.values[PerfCounters::instructions] / count : NAN;
+}
+
+// The instruction counts of two Run()s side by side, if both were counted
+static void PrintInstructionComparison(const char* name, double instructions, const char* baseline_name,
+                                       double baseline_instructions) {
+    if (!isnan(instructions) && !isnan(baseline_instructions)) {
+        printf("    %s: %.2f instructions/call, %s: %.2f\n", name, instructions, baseline_name, baseline_instructions);
+    }
+}
+
+// Calls a batch kernel over `count` inputs `repeats` times and prints the average time per element
+template <typename Func>
+static void RunBatch(const char* name, size_t count, Func func, int repeats = NUM_REPEATS) {
+    StartCounters();
+    auto start = std::chrono::steady_clock::now();
+
+    for (int repeat = 0; repeat < repeats; repeat++) {
+        func();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    auto sample = StopCounters();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    PrintResult(name, ns, (double) count * repeats, "element", sample);
+}
+
+static void BenchBatchKernels(const BatchKernels& kernels, const char* isa_name) {
+    auto numbers = RandomInputs<uint32_t>(0xffffffff);
+    auto angles = RandomInputs<int32_t>(0xffffffff);
+    std::vector<uint32_t> roots(NUM_INPUTS);
+    std::vector<int32_t> out(NUM_INPUTS);
+    char name[64];
+
+    snprintf(name, sizeof(name), "SqrtuBatch<6, 10> [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.sqrtu(numbers.data(), roots.data(), NUM_INPUTS, 6, 10); });
+
+    std::vector<uint8_t> numbers8(numbers.begin(), numbers.end());
+    std::vector<uint16_t> numbers16(numbers.begin(), numbers.end());
+    std::vector<uint32_t> numbers24(NUM_INPUTS);
+    std::vector<uint8_t> roots8(NUM_INPUTS);
+    std::vector<uint16_t> roots16(NUM_INPUTS);
+
+    for (size_t i = 0; i < NUM_INPUTS; i++) {
+        numbers24[i] = numbers[i] & 0xffffff;
+    }
+
+    snprintf(name, sizeof(name), "SqrtBatchU8 [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.sqrt_u8(numbers8.data(), roots8.data(), NUM_INPUTS); });
+
+    snprintf(name, sizeof(name), "SqrtBatchU16 [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.sqrt_u16(numbers16.data(), roots8.data(), NUM_INPUTS); });
+
+    snprintf(name, sizeof(name), "SqrtBatchU24 [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.sqrt_u24(numbers24.data(), roots16.data(), NUM_INPUTS); });
+
+    snprintf(name, sizeof(name), "Log2floorBatch [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.log2floor(numbers.data(), out.data(), NUM_INPUTS); });
+
+    snprintf(name, sizeof(name), "Log2ceilBatch [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.log2ceil(numbers.data(), out.data(), NUM_INPUTS); });
+
+    snprintf(name, sizeof(name), "SinBatch<12> [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.sin(angles.data(), out.data(), NUM_INPUTS, 12); });
+
+    for (size_t count : {(size_t) NUM_INPUTS, (size_t) 256}) {
+        snprintf(name, sizeof(name), "SinDeltaBatch<12> x%zu [%s]", count, isa_name);
+        RunBatch(name, count, [&] {
+            kernels.sin_delta(angles.data(), out.data(), count, 12);
+        }, count == NUM_INPUTS ? NUM_REPEATS : NUM_REPEATS * 256);
+    }
+
+    snprintf(name, sizeof(name), "SinBatch<12> x256 [%s]", isa_name);
+    RunBatch(name, 256, [&] { kernels.sin(angles.data(), out.data(), 256, 12); }, NUM_REPEATS * 256);
+
+    std::vector<int16_t> angles16(angles.begin(), angles.end());
+    std::vector<int16_t> out16(NUM_INPUTS);
+
+    snprintf(name, sizeof(name), "SinBatch<16> [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.sin(angles.data(), out.data(), NUM_INPUTS, 16); });
+
+    snprintf(name, sizeof(name), "SinBatchI16<16> [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.sin_i16(angles16.data(), out16.data(), NUM_INPUTS, 16); });
+
+    snprintf(name, sizeof(name), "CosBatch<16> [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.cos(angles.data(), out.data(), NUM_INPUTS, 16); });
+
+    auto xs = RandomInputs<int32_t>(0xfffff);
+    auto ys = RandomInputs<int32_t>(0xffff);
+    std::vector<int32_t> out_y(NUM_INPUTS);
+
+    snprintf(name, sizeof(name), "Rotate2D [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] {
+        kernels.rotate2d(xs.data(), ys.data(), out.data(), out_y.data(), NUM_INPUTS, 2896, 2896);
+    });
+
+    snprintf(name, sizeof(name), "Rotate2DPerPoint<16> [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] {
+        kernels.rotate2d_per_point(xs.data(), ys.data(), angles.data(), out.data(), out_y.data(), NUM_INPUTS, 16);
+    });
+
+    snprintf(name, sizeof(name), "SinSweep<16> (chirp) [%s]", isa_name);
+    RunBatch(name, NUM_INPUTS, [&] { kernels.sin_sweep(out.data(), NUM_INPUTS, 0, 0x01000000, 123, 16); });
+}
+
+// What Rotate2DPerPoint replaces: Sin and Cos called separately for every point
+static void BenchRotateLoop() {
+    auto xs = RandomInputs<int32_t>(0xfffff);
+    auto ys = RandomInputs<int32_t>(0xffff);
+    auto angles = RandomInputs<int32_t>(0xffff);
+    std::vector<int32_t> out_x(NUM_INPUTS);
+    std::vector<int32_t> out_y(NUM_INPUTS);
+
+    RunBatch("Sin<16>, Cos<16> per point", NUM_INPUTS, [&] {
+        for (size_t i = 0; i < NUM_INPUTS; i++) {
+            int32_t cos = Cos<16>(angles[i]);
+            int32_t sin = Sin<16>(angles[i]);
+
+            out_x[i] = (int32_t) (((int64_t) xs[i] * cos - (int64_t) ys[i] * sin + 2048) >> 12);
+            out_y[i] = (int32_t) (((int64_t) xs[i] * sin + (int64_t) ys[i] * cos + 2048) >> 12);
+        }
+    });
+}
+
+// 1024-point forward transforms of full-scale noise; the input is restored before every transform
+template <typename Sample_t>
+static void BenchFft(const char* name) {
+    Fft<Sample_t> fft(10);
+    auto samples = RandomInputs<Sample_t>(0xffffffff);
+    auto input = (const Complex<Sample_t>*) samples.data();
+    std::vector<Complex<Sample_t>> data(fft.GetSize());
+
+    RunBatch(name, fft.GetSize(), [&] {
+        std::copy(input, input + fft.GetSize(), data.begin());
+        sink = fft.Forward(data.data());
+    }, 20000);
+}
+
+// Streaming into a ring of 4096 samples in blocks of 1000, against a phase accumulator stepped one sample at a time
+static void BenchDds() {
+    std::vector<int32_t> storage(4096);
+    DdsRing ring = {storage.data(), storage.size(), 0};
+    constexpr size_t block = 1000;
+    constexpr int repeats = 20000;
+
+    RunBatch("Sin<16> per sample, tone", block, [&] {
+        static uint32_t phase = 0;
+
+        for (size_t i = 0; i < block; i++) {
+            storage[ring.head] = Sin<16>((int32_t) (phase >> 16));
+            ring.head = (ring.head + 1) % storage.size();
+            phase += 0x01000000;
+        }
+    }, repeats);
+
+    Dds<16> dds;
+    dds.SetTone(0x01000000);
+    RunBatch("Dds<16> tone into ring", block, [&] { dds.Generate(ring, block); }, repeats);
+
+    dds.SetChirp(0x00100000, 0x10000000, 48000);
+    RunBatch("Dds<16> chirp into ring", block, [&] { dds.Generate(ring, block); }, repeats);
+
+    const uint32_t tone_steps[] = {0x01000000, 0x02000000, 0x03000000, 0x04000000};
+    const uint8_t symbols[] = {0, 3, 1, 2, 2, 0, 1, 3};
+    dds.SetFsk(tone_steps, symbols, 8, 64);
+    RunBatch("Dds<16> FSK, 64 samples/symbol, into ring", block, [&] { dds.Generate(ring, block); }, repeats);
+}
+
+// Throughput of the parallel entry points on an array much larger than the caches, for growing thread counts
+static void BenchParallel() {
+    constexpr size_t count = 1 << 26;
+    constexpr int repeats = 4;
+
+    std::vector<uint32_t> numbers(count);
+    std::vector<uint32_t> roots(count);
+    uint32_t state = 0x12345678;
+
+    for (auto& number : numbers) {
+        number = Xorshift32(state);
+    }
+
+    auto angles = (const int32_t*) numbers.data();
+    auto out = (int32_t*) roots.data();
+    int max_threads = (int) std::thread::hardware_concurrency();
+
+    for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+        ThreadPool pool(num_threads);
+        ParallelConfig config = {&pool, DEFAULT_CHUNK_SIZE};
+        char name[64];
+
+        snprintf(name, sizeof(name), "SqrtuBatchParallel<6, 10> [%d threads]", num_threads);
+        RunBatch(name, count, [&] { SqrtuBatchParallel(numbers.data(), roots.data(), count, config); }, repeats);
+
+        snprintf(name, sizeof(name), "SinBatchParallel<16> [%d threads]", num_threads);
+        RunBatch(name, count, [&] { SinBatchParallel<16>(angles, out, count, config); }, repeats);
+    }
+}
+
+// Sin as it was before interpolation was restructured around unsigned shifts, kept for comparison
+template <int angle_bits, typename Angle_t>
+static int32_t SinSignedDivide(Angle_t angle) {
+    constexpr int interp_bits = (angle_bits - 2 - SIN_TABLE_BITS);
+
+    constexpr int interp_max = (1 << interp_bits);
+    constexpr int interp_mask = (1 << interp_bits) - 1;
+
+    constexpr int angle_half_bit = 1 << (angle_bits - 1);
+    constexpr int angle_quarter_bit = 1 << (angle_bits - 2);
+
+    int index, index2, interp_pos;
+
+    if ((angle & angle_quarter_bit) == 0) {
+        index = (angle >> interp_bits) & index_mask;
+        index2 = index + 1;
+        interp_pos = angle & interp_mask;
+    }
+    else {
+        index = sin_table_size - 1 - ((angle >> interp_bits) & index_mask) - 1;
+        index2 = index + 1;
+        interp_pos = interp_max - (angle & interp_mask);
+    }
+
+    int32_t interpolated = (sin_table[index] + (((sin_table[index2] - sin_table[index]) * interp_pos + interp_max / 2) / interp_max));
+
+    if ((angle & angle_half_bit) == 0) {
+        return interpolated;
+    }
+    else {
+        return -interpolated;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && strcmp(argv[1], "--counters") == 0) {
+        static PerfCounters counters;
+
+        if (counters.IsAvailable()) {
+            perf_counters = &counters;
+        }
+        else {
+            printf("Hardware counters not available (%s), timing only\n\n", counters.GetError());
+        }
+    }
+
+    auto angles32 = RandomInputs<int32_t>(0xffffffff);
+    auto angles16 = RandomInputs<int16_t>(0xffff);
+
+    // the unsigned interpolation is meant to take fewer instructions per call than the signed divide it replaced
+    double divide12 = Run("Sin<12, int32_t> (signed divide)", angles32,
+                          [](int32_t angle) { return SinSignedDivide<12>(angle); });
+    double unsigned12 = Run("Sin<12, int32_t>", angles32, [](int32_t angle) { return Sin<12>(angle); });
+    PrintInstructionComparison("Sin<12>", unsigned12, "signed divide", divide12);
+
+    double divide16 = Run("Sin<16, int16_t> (signed divide)", angles16,
+                          [](int16_t angle) { return SinSignedDivide<16>(angle); });
+    double unsigned16 = Run("Sin<16, int16_t>", angles16, [](int16_t angle) { return Sin<16>(angle); });
+    PrintInstructionComparison("Sin<16>", unsigned16, "signed divide", divide16);
+
+    Run("Cos<16, int16_t>", angles16, [](int16_t angle) { return Cos<16>(angle); });
+    Run("SinDelta<16, int16_t>", angles16, [](int16_t angle) { return SinDelta<16>(angle); });
+    Run("SinOctant<16, int16_t>", angles16, [](int16_t angle) { return SinOctant<16>(angle); });
+    Run("Sin<16> + Cos<16>, int16_t", angles16, [](int16_t angle) { return Sin<16>(angle) + Cos<16>(angle); });
+    Run("SinCosOctant<16, int16_t>", angles16, [](int16_t angle) {
+        int32_t sin, cos;
+        SinCosOctant<16>(angle, sin, cos);
+        return sin + cos;
+    });
+
+    auto angles8 = RandomInputs<uint8_t>(0xff);
+    Run("Sin<8, uint8_t> (direct)", angles8, [](uint8_t angle) { return Sin<8>(angle); });
+#if SIN_TABLE_BITS <= 6
+    Run("Sin<8, uint8_t> (interpolated)", angles8, [](uint8_t angle) { return SinInterpolated<8, uint8_t>(angle); });
+#endif
+
+    Run("SinQ30<32, int32_t>", angles32, [](int32_t angle) { return SinQ30<32>(angle); });
+    Run("sin (libm double), Q30", angles32, [](int32_t angle) {
+        return (int32_t) lrint(ldexp(sin(angle * (M_PI / 2147483648.0)), 30));
+    });
+
+    Run("Sin<Fast, 16, int16_t>", angles16, [](int16_t angle) { return Sin<Fast, 16>(angle); });
+    Run("Sin<Balanced, 16, int16_t>", angles16, [](int16_t angle) { return Sin<Balanced, 16>(angle); });
+    Run("Sin<Exact, 16, int16_t>", angles16, [](int16_t angle) { return Sin<Exact, 16>(angle); });
+
+    auto numbers = RandomInputs<uint32_t>(0xffffffff);
+    Run("Sqrtu<Fast>", numbers, [](uint32_t number) { return Sqrtu<Fast>(number); });
+    Run("Sqrtu<Balanced>", numbers, [](uint32_t number) { return Sqrtu<Balanced>(number); });
+    Run("Sqrtu<Exact>", numbers, [](uint32_t number) { return Sqrtu<Exact>(number); });
+
+    Run("Tan<Fast, 16, int16_t>", angles16, [](int16_t angle) { return Tan<Fast, 16>(angle); });
+    Run("Tan<Exact, 16, int16_t>", angles16, [](int16_t angle) { return Tan<Exact, 16>(angle); });
+
+    Run("Sin<16, int16_t> / Cos<16, int16_t>", angles16, [](int16_t angle) {
+        int32_t cos = Cos<16>(angle);
+        return cos ? Sin<16>(angle) * 4096 / cos : INT32_MAX;
+    });
+    Run("Tan<16, int16_t>", angles16, [](int16_t angle) { return Tan<16>(angle); });
+
+    // ratios in [-1, 1) with 12 fractional bits, as returned by Sin
+    auto ratios = RandomInputs<int32_t>(0x1fff);
+    for (auto& ratio : ratios) { ratio -= 0x1000; }
+
+    Run("acosf", ratios, [](int32_t ratio) { return (int32_t) (acosf(ratio * (1.0f / 4096)) * (65536 / 6.2831853f)); });
+    Run("Acos<16, int32_t>", ratios, [](int32_t ratio) { return Acos<16>(ratio); });
+
+    BenchRotateLoop();
+    BenchDds();
+    BenchFft<int16_t>("FftQ15::Forward, 1024 points");
+    BenchFft<int32_t>("FftQ31::Forward, 1024 points");
+
+    for (int i = 0; i < NUM_ISAS; i++) {
+        if (auto kernels = GetBatchKernels((Isa) i)) {
+            BenchBatchKernels(*kernels, IsaName((Isa) i));
+        }
+    }
+
+    BenchParallel();
+
+#ifdef FIXED_POINT_MATH_INSTRUMENT
+    printf("\n");
+    WriteInstrumentCsv(GetInstrumentSnapshot(), stdout);
+#endif
+}
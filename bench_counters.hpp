@@ -0,0 +1,142 @@
+#ifndef FIXED_POINT_MATH_BENCH_COUNTERS_HPP
+#define FIXED_POINT_MATH_BENCH_COUNTERS_HPP
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Hardware event counters around benchmark runs, read through perf_event_open on Linux.
+//
+// All events are opened as one group, so they are counted over exactly the same instructions. If the kernel
+// multiplexes the group with other users of the PMU, the counts are scaled up by enabled / running time. Events the
+// CPU (or the hypervisor) does not support are left out individually; without cycles, nothing is counted at all.
+// Only user space is counted, which perf_event_paranoid <= 2 allows for the process itself.
+
+class PerfCounters {
+public:
+    enum Event {
+        cycles,
+        instructions,
+        branch_misses,
+        l1d_misses,
+        NUM_EVENTS,
+    };
+
+    struct Sample {
+        uint64_t values[NUM_EVENTS];
+        bool valid[NUM_EVENTS];
+    };
+
+    PerfCounters() {
+#ifdef __linux__
+        static const uint32_t types[NUM_EVENTS] = {
+                PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+        static const uint64_t configs[NUM_EVENTS] = {
+                PERF_COUNT_HW_CPU_CYCLES,
+                PERF_COUNT_HW_INSTRUCTIONS,
+                PERF_COUNT_HW_BRANCH_MISSES,
+                PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+        };
+
+        for (int event = 0; event < NUM_EVENTS; event++) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = types[event];
+            attr.config = configs[event];
+            attr.disabled = (event == cycles);     // the leader starts and stops the whole group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                               PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            fds[event] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, event == cycles ? -1 : fds[cycles], 0);
+
+            if (fds[event] < 0) {
+                if (event == cycles) {
+                    error = errno;
+                    return;
+                }
+
+                continue;
+            }
+
+            ioctl(fds[event], PERF_EVENT_IOC_ID, &ids[event]);
+        }
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool IsAvailable() const { return fds[cycles] >= 0; }
+
+    // Why the counters are not available
+    const char* GetError() const {
+#ifdef __linux__
+        return strerror(error);
+#else
+        return "perf_event_open is Linux only";
+#endif
+    }
+
+    void Start() {
+#ifdef __linux__
+        ioctl(fds[cycles], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[cycles], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    Sample Stop() {
+        Sample sample = {};
+
+#ifdef __linux__
+        ioctl(fds[cycles], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+        // nr, time_enabled, time_running, then a value and an id per event
+        uint64_t data[3 + 2 * NUM_EVENTS];
+
+        if (read(fds[cycles], data, sizeof(data)) < (ssize_t) (3 * sizeof(uint64_t)) || data[2] == 0) {
+            return sample;
+        }
+
+        double scale = (double) data[1] / (double) data[2];
+
+        for (uint64_t i = 0; i < data[0] && i < NUM_EVENTS; i++) {
+            for (int event = 0; event < NUM_EVENTS; event++) {
+                if (fds[event] >= 0 && ids[event] == data[4 + 2 * i]) {
+                    sample.values[event] = (uint64_t) ((double) data[3 + 2 * i] * scale);
+                    sample.valid[event] = true;
+                }
+            }
+        }
+#endif
+
+        return sample;
+    }
+
+private:
+    int fds[NUM_EVENTS] = {-1, -1, -1, -1};
+    uint64_t ids[NUM_EVENTS] = {};
+    int error = 0;
+};
+
+#endif
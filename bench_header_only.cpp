@@ -0,0 +1,80 @@
+// Tight loops over the scalar functions, built twice: `bench_header_only` against the header-only configuration and
+// `bench_header_only_library` against the static library. Comparing the two shows what the out-of-line calls cost.
+
+#include "fixed_point_math.hpp"
+
+#include <chrono>
+#include <stdio.h>
+#include <vector>
+
+#ifdef FIXED_POINT_MATH_HEADER_ONLY
+static const char* const mode = "header-only";
+#else
+static const char* const mode = "library";
+#endif
+
+constexpr size_t NUM_INPUTS = 1 << 16;
+constexpr int NUM_REPEATS = 200;
+
+static volatile int64_t sink;
+
+static std::vector<uint32_t> RandomInputs(uint32_t mask) {
+    std::vector<uint32_t> inputs(NUM_INPUTS);
+    uint32_t state = 0x12345678;
+
+    for (auto& input : inputs) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        input = state & mask;
+    }
+
+    return inputs;
+}
+
+// Sums func over every input NUM_REPEATS times and prints the average time per call
+template <typename Func>
+static void Run(const char* name, const std::vector<uint32_t>& inputs, Func func) {
+    int64_t sum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int repeat = 0; repeat < NUM_REPEATS; repeat++) {
+        for (auto input : inputs) {
+            sum += func(input);
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    sink = sum;
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s [%s]", name, mode);
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%-40s %8.3f ns/call\n", label, ns / ((double) inputs.size() * NUM_REPEATS));
+}
+
+int main() {
+    auto numbers = RandomInputs(0xffffffff);
+    auto angles = RandomInputs(0xffff);
+    auto ratios = RandomInputs(0x1fff);
+
+    // consecutive inputs take the same branches, so only the arithmetic and the calls are left to measure
+    std::vector<uint32_t> sequential(NUM_INPUTS);
+
+    for (size_t i = 0; i < NUM_INPUTS; i++) {
+        sequential[i] = (uint32_t) (i << 12);
+    }
+
+    Run("Log2floor", numbers, [](uint32_t v) { return Log2floor(v); });
+    Run("Log2ceil", numbers, [](uint32_t v) { return Log2ceil(v); });
+    Run("Log2floor, sequential", sequential, [](uint32_t v) { return Log2floor(v); });
+    Run("Sqrtu<6, 10>, sequential", sequential, [](uint32_t v) { return Sqrtu<6, 10>(v); });
+    Run("Sqrtu<6, 10>", numbers, [](uint32_t v) { return Sqrtu<6, 10>(v); });
+    Run("Sqrtu<Fast>", numbers, [](uint32_t v) { return Sqrtu<Fast>(v); });
+    Run("Sqrtu<Exact>", numbers, [](uint32_t v) { return Sqrtu<Exact>(v); });
+    Run("Sin<16>", angles, [](uint32_t v) { return Sin<16, uint32_t>(v); });
+    Run("Tan<16>", angles, [](uint32_t v) { return Tan<16, uint32_t>(v); });
+    Run("Asin<16>", ratios, [](uint32_t v) { return Asin<16, int32_t>((int32_t) v - 4096); });
+}
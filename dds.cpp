@@ -0,0 +1,136 @@
+#include "dds.hpp"
+
+#include <doctest.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+// The accumulator one sample at a time, for the same waveforms as Dds
+struct DdsReference {
+    uint32_t phase = 0;
+    uint32_t step = 0;
+
+    int32_t Next(uint32_t step_delta = 0) {
+        int32_t sample = Sin<16, int32_t>((int32_t) (phase >> 16));
+        phase += step;
+        step += step_delta;
+        return sample;
+    }
+};
+
+// Block sizes that do not line up with vectors, chirps or symbols
+static void GenerateInOddBlocks(Dds<16>& dds, std::vector<int32_t>& out) {
+    size_t block = 1;
+
+    for (size_t i = 0; i < out.size(); i += block, block = block * 3 % 31 + 1) {
+        dds.Generate(&out[i], std::min(block, out.size() - i));
+    }
+}
+
+TEST_CASE("DdsStep") {
+    CHECK_EQ(DdsStep(0, 48000), 0);
+    CHECK_EQ(DdsStep(12000, 48000), UINT32_C(1) << 30);
+    CHECK_EQ(DdsStep(1, 3), 0x55555555);
+    CHECK_EQ(DdsStep(2, 3), 0xaaaaaaab);
+}
+
+TEST_CASE("Dds: tone") {
+    Dds<16> dds;
+    DdsReference reference;
+
+    dds.SetPhase(0x12345678);
+    dds.SetTone(DdsStep(1000, 48000));
+    reference.phase = 0x12345678;
+    reference.step = DdsStep(1000, 48000);
+
+    std::vector<int32_t> out(5000);
+    GenerateInOddBlocks(dds, out);
+
+    for (size_t i = 0; i < out.size(); i++) {
+        REQUIRE_EQ(out[i], reference.Next());
+    }
+
+    CHECK_EQ(dds.GetPhase(), reference.phase);
+
+    // switching the frequency does not reset the phase
+    dds.SetTone(0x7fffffff);
+    reference.step = 0x7fffffff;
+    dds.Generate(out.data(), 100);
+
+    for (size_t i = 0; i < 100; i++) {
+        REQUIRE_EQ(out[i], reference.Next());
+    }
+}
+
+TEST_CASE("Dds: chirp") {
+    for (auto [start, end] : {std::pair<uint32_t, uint32_t>{0x01000000, 0x10000000}, {0x40000000, 0x00100000}}) {
+        Dds<16> dds;
+        DdsReference reference;
+
+        constexpr uint32_t length = 777;
+        const uint32_t delta = (uint32_t) (((int64_t) end - (int64_t) start) / length);
+
+        dds.SetChirp(start, end, length);
+
+        std::vector<int32_t> out(3 * length + 100);
+        GenerateInOddBlocks(dds, out);
+
+        // three sweeps and the start of a fourth
+        for (size_t i = 0; i < out.size(); i++) {
+            if (i % length == 0) {
+                reference.step = start;
+            }
+
+            REQUIRE_EQ(out[i], reference.Next(delta));
+        }
+
+        CHECK_EQ(dds.GetPhase(), reference.phase);
+    }
+}
+
+TEST_CASE("Dds: FSK") {
+    const uint32_t tone_steps[] = {DdsStep(1200, 9600), DdsStep(2200, 9600)};
+    const uint8_t symbols[] = {0, 1, 1, 0, 1};
+    constexpr uint32_t samples_per_symbol = 8;
+
+    Dds<16> dds;
+    DdsReference reference;
+
+    dds.SetFsk(tone_steps, symbols, 5, samples_per_symbol);
+
+    std::vector<int32_t> out(1000);
+    GenerateInOddBlocks(dds, out);
+
+    for (size_t i = 0; i < out.size(); i++) {
+        reference.step = tone_steps[symbols[i / samples_per_symbol % 5]];
+        REQUIRE_EQ(out[i], reference.Next());
+    }
+}
+
+TEST_CASE("Dds: ring buffer") {
+    Dds<16> tone;
+    Dds<16> ring_tone;
+    tone.SetTone(0x00c0ffee);
+    ring_tone.SetTone(0x00c0ffee);
+
+    std::vector<int32_t> expected(1000);
+    tone.Generate(expected.data(), expected.size());
+
+    std::vector<int32_t> storage(100);
+    DdsRing ring = {storage.data(), storage.size(), 0};
+    size_t written = 0;
+
+    // blocks that wrap around, one that fills the whole ring exactly, and one longer than the ring
+    for (size_t block : {30, 90, 100, 3, 250, 17}) {
+        ring_tone.Generate(ring, block);
+        written += block;
+
+        REQUIRE_EQ(ring.head, written % storage.size());
+
+        // the last min(block, capacity) samples are in place
+        for (size_t i = written - std::min(block, storage.size()); i < written; i++) {
+            REQUIRE_EQ(storage[i % storage.size()], expected[i]);
+        }
+    }
+}
@@ -0,0 +1,148 @@
+#ifndef FIXED_POINT_MATH_DDS_HPP
+#define FIXED_POINT_MATH_DDS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "batch.hpp"
+#include "dispatch.hpp"
+
+// Direct digital synthesis: a 32-bit phase accumulator, 2**32 units per turn, read out through Sin.
+//
+// Tones, linear chirps and continuous-phase FSK are generated in blocks, either into a plain array or into a ring
+// buffer owned by the caller. The generator holds no buffers and never allocates; its whole state is a handful of
+// integers, so one generator per channel is cheap and channels can run on separate threads. Every block goes
+// through the sin_sweep batch kernel, which advances the accumulator in vector registers.
+//
+// Samples have 12 fractional bits, like Sin. The phase is truncated to angle_bits before the lookup.
+
+// Phase step per sample for a frequency given in the same units as the sample rate; frequency < sample_rate < 2**32
+inline uint32_t DdsStep(uint64_t frequency, uint64_t sample_rate) {
+    return (uint32_t) (((frequency << 32) + sample_rate / 2) / sample_rate);
+}
+
+// Samples are appended at `head`, which wraps around at `capacity`. Reading them out is up to the caller.
+struct DdsRing {
+    int32_t* data;
+    size_t capacity;
+    size_t head;
+};
+
+template <int angle_bits = 16>
+class Dds {
+public:
+    static_assert(angle_bits >= SIN_TABLE_BITS + 2 && angle_bits <= MAX_BATCH_ANGLE_BITS, "angle_bits out of range");
+
+    // Starts as a tone of step 0, at phase 0
+    Dds() = default;
+
+    // Changing the waveform keeps the phase, so the output stays continuous
+    uint32_t GetPhase() const { return phase; }
+    void SetPhase(uint32_t new_phase) { phase = new_phase; }
+
+    void SetTone(uint32_t step) {
+        mode = Mode::tone;
+        current_step = step;
+        step_delta = 0;
+    }
+
+    // Linear sweep from start_step towards end_step over `length` samples, then again from start_step. The step
+    // changes by (end_step - start_step) / length on every sample, rounded towards zero. length must not be 0.
+    void SetChirp(uint32_t start_step, uint32_t end_step, uint32_t length) {
+        mode = Mode::chirp;
+        chirp_start = start_step;
+        chirp_length = length;
+        step_delta = (uint32_t) (((int64_t) end_step - (int64_t) start_step) / (int64_t) length);
+        StartSegment(start_step, length);
+    }
+
+    // Symbol s is sent as a tone of tone_steps[s] for samples_per_symbol samples, without phase jumps. The symbol
+    // sequence repeats; it must not be empty, nor may samples_per_symbol be 0. Both arrays stay owned by the caller
+    // and must outlive any Generate call in this mode.
+    void SetFsk(const uint32_t* tone_steps, const uint8_t* symbols, size_t num_symbols, uint32_t samples_per_symbol) {
+        mode = Mode::fsk;
+        fsk_tone_steps = tone_steps;
+        fsk_symbols = symbols;
+        fsk_num_symbols = num_symbols;
+        fsk_samples_per_symbol = samples_per_symbol;
+        fsk_next_symbol = 1 % num_symbols;
+        step_delta = 0;
+        StartSegment(tone_steps[symbols[0]], samples_per_symbol);
+    }
+
+    void Generate(int32_t* out, size_t count) {
+        const BatchKernels& kernels = GetBatchKernels();
+
+        while (count > 0) {
+            size_t block = (mode == Mode::tone || count < segment_remaining) ? count : segment_remaining;
+
+            kernels.sin_sweep(out, block, phase, current_step, step_delta, angle_bits);
+            Advance(block);
+
+            out += block;
+            count -= block;
+        }
+    }
+
+    void Generate(DdsRing& ring, size_t count) {
+        while (count > 0) {
+            size_t block = (count < ring.capacity - ring.head) ? count : ring.capacity - ring.head;
+
+            Generate(&ring.data[ring.head], block);
+
+            ring.head = (ring.head + block == ring.capacity) ? 0 : ring.head + block;
+            count -= block;
+        }
+    }
+
+private:
+    enum class Mode { tone, chirp, fsk };
+
+    void StartSegment(uint32_t step, size_t length) {
+        current_step = step;
+        segment_remaining = length;
+    }
+
+    // Moves the accumulator n samples ahead, within the current segment
+    void Advance(size_t n) {
+        // n (n - 1) / 2 modulo 2**32, without overflowing for large n
+        uint32_t triangle = (n % 2 == 0) ? (uint32_t) (n / 2) * (uint32_t) (n - 1)
+                                         : (uint32_t) n * (uint32_t) ((n - 1) / 2);
+
+        phase += (uint32_t) n * current_step + triangle * step_delta;
+        current_step += (uint32_t) n * step_delta;
+
+        if (mode == Mode::tone) {
+            return;
+        }
+
+        segment_remaining -= n;
+
+        if (segment_remaining == 0) {
+            if (mode == Mode::chirp) {
+                StartSegment(chirp_start, chirp_length);
+            }
+            else {
+                StartSegment(fsk_tone_steps[fsk_symbols[fsk_next_symbol]], fsk_samples_per_symbol);
+                fsk_next_symbol = (fsk_next_symbol + 1 == fsk_num_symbols) ? 0 : fsk_next_symbol + 1;
+            }
+        }
+    }
+
+    Mode mode = Mode::tone;
+    uint32_t phase = 0;
+    uint32_t current_step = 0;
+    uint32_t step_delta = 0;
+    size_t segment_remaining = 0;       // samples left in the current chirp or FSK symbol
+
+    uint32_t chirp_start = 0;
+    uint32_t chirp_length = 0;
+
+    const uint32_t* fsk_tone_steps = nullptr;
+    const uint8_t* fsk_symbols = nullptr;
+    size_t fsk_num_symbols = 0;
+    uint32_t fsk_samples_per_symbol = 0;
+    size_t fsk_next_symbol = 0;
+};
+
+#endif
@@ -0,0 +1,557 @@
+#include "arith.hpp"
+#include "batch.hpp"
+#include "dispatch.hpp"
+#include "log2.hpp"
+#include "rotate.hpp"
+#include "sqrt.hpp"
+
+#include <doctest.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+extern const BatchKernels batch_kernels_scalar;
+
+#ifdef FIXED_POINT_MATH_X86_KERNELS
+extern const BatchKernels batch_kernels_sse42;
+extern const BatchKernels batch_kernels_avx2;
+extern const BatchKernels batch_kernels_avx512;
+#endif
+
+// Indexed by Isa; nullptr where the kernels are not compiled in
+static const BatchKernels* const compiled_kernels[NUM_ISAS] = {
+        &batch_kernels_scalar,
+#ifdef FIXED_POINT_MATH_X86_KERNELS
+        &batch_kernels_sse42,
+        &batch_kernels_avx2,
+        &batch_kernels_avx512,
+#else
+        nullptr,
+        nullptr,
+        nullptr,
+#endif
+};
+
+static const char* const isa_names[NUM_ISAS] = {"scalar", "sse4.2", "avx2", "avx512"};
+
+const char* IsaName(Isa isa) {
+    return isa_names[(int) isa];
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Which register state the OS saves on context switch
+static uint64_t Xgetbv() {
+    uint32_t eax, edx;
+    __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (uint64_t) edx << 32 | eax;
+}
+
+Isa DetectIsa() {
+    unsigned int eax, ebx, ecx, edx;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx) || !(ecx & bit_SSE4_2)) {
+        return Isa::scalar;
+    }
+
+    // AVX state (XMM + YMM) must be enabled by the OS, not only supported by the CPU
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX) || (Xgetbv() & 0x06) != 0x06) {
+        return Isa::sse42;
+    }
+
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) || !(ebx & bit_AVX2)) {
+        return Isa::sse42;
+    }
+
+    // opmask + ZMM state
+    constexpr unsigned int avx512_bits = bit_AVX512F | bit_AVX512CD | bit_AVX512BW | bit_AVX512DQ | bit_AVX512VL;
+
+    if ((ebx & avx512_bits) != avx512_bits || (Xgetbv() & 0xe6) != 0xe6) {
+        return Isa::avx2;
+    }
+
+    return Isa::avx512;
+}
+#else
+Isa DetectIsa() {
+    return Isa::scalar;
+}
+#endif
+
+static Isa SelectIsa() {
+    Isa detected = DetectIsa();
+    Isa isa = detected;
+
+    if (const char* requested = getenv("FIXED_POINT_MATH_ISA")) {
+        int i = 0;
+
+        while (i < NUM_ISAS && strcmp(requested, isa_names[i]) != 0) {
+            i++;
+        }
+
+        if (i == NUM_ISAS) {
+            fprintf(stderr, "FIXED_POINT_MATH_ISA: unknown instruction set '%s'\n", requested);
+        }
+        else if (i > (int) detected) {
+            fprintf(stderr, "FIXED_POINT_MATH_ISA: %s not supported by this CPU, using %s\n", requested,
+                    IsaName(detected));
+        }
+        else {
+            isa = (Isa) i;
+        }
+    }
+
+    // fall back to the best level that is compiled in
+    while (!compiled_kernels[(int) isa]) {
+        isa = (Isa) ((int) isa - 1);
+    }
+
+    return isa;
+}
+
+Isa GetSelectedIsa() {
+    static const Isa isa = SelectIsa();
+    return isa;
+}
+
+const BatchKernels& GetBatchKernels() {
+    static const BatchKernels& kernels = *compiled_kernels[(int) GetSelectedIsa()];
+    return kernels;
+}
+
+const BatchKernels* GetBatchKernels(Isa isa) {
+    if ((int) isa > (int) DetectIsa()) {
+        return nullptr;
+    }
+
+    return compiled_kernels[(int) isa];
+}
+
+// Edge cases around every power of two, followed by pseudo-random values. Deliberately not a multiple of any
+// vector width, so that the tail handling is exercised too.
+static std::vector<uint32_t> BatchTestInputs() {
+    std::vector<uint32_t> inputs;
+
+    for (int bit = 0; bit < 32; bit++) {
+        uint32_t power = UINT32_C(1) << bit;
+        inputs.insert(inputs.end(), {power - 1, power, power + 1, power | (power >> 1)});
+    }
+
+    inputs.push_back(UINT32_MAX);
+
+    uint32_t state = 1;
+
+    while (inputs.size() < 5003) {
+        state = state * 1664525 + 1013904223;
+        // vary the magnitude too, not only the value
+        inputs.push_back(state >> (state % 29));
+    }
+
+    return inputs;
+}
+
+template <int TOLERANCE_BITS, int MAX_ITERATIONS>
+static void CheckSqrtuKernel(const BatchKernels& kernels, const std::vector<uint32_t>& inputs) {
+    std::vector<uint32_t> out(inputs.size());
+    kernels.sqrtu(inputs.data(), out.data(), inputs.size(), TOLERANCE_BITS, MAX_ITERATIONS);
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        CHECK_EQ(out[i], Sqrtu<TOLERANCE_BITS, MAX_ITERATIONS>(inputs[i]));
+    }
+}
+
+template <int angle_bits>
+static void CheckSinCosKernels(const BatchKernels& kernels, const std::vector<uint32_t>& inputs) {
+    std::vector<int32_t> angles(inputs.begin(), inputs.end());
+    std::vector<int32_t> out(inputs.size());
+
+    kernels.sin(angles.data(), out.data(), angles.size(), angle_bits);
+
+    for (size_t i = 0; i < angles.size(); i++) {
+        CHECK_EQ(out[i], Sin<angle_bits, int32_t>(angles[i]));
+    }
+
+    kernels.cos(angles.data(), out.data(), angles.size(), angle_bits);
+
+    for (size_t i = 0; i < angles.size(); i++) {
+        CHECK_EQ(out[i], Cos<angle_bits, int32_t>(angles[i]));
+    }
+
+    kernels.sin_delta(angles.data(), out.data(), angles.size(), angle_bits);
+
+    for (size_t i = 0; i < angles.size(); i++) {
+        CHECK_EQ(out[i], Sin<angle_bits, int32_t>(angles[i]));
+    }
+}
+
+// Every int16_t angle, also in a tail of each length
+template <int angle_bits>
+static void CheckSinCosI16Kernels(const BatchKernels& kernels) {
+    std::vector<int16_t> angles(65536);
+    std::vector<int16_t> out(angles.size());
+
+    for (size_t i = 0; i < angles.size(); i++) {
+        angles[i] = (int16_t) (i * 40503);
+    }
+
+    kernels.sin_i16(angles.data(), out.data(), angles.size(), angle_bits);
+
+    for (size_t i = 0; i < angles.size(); i++) {
+        CHECK_EQ(out[i], Sin<angle_bits, int16_t>(angles[i]));
+    }
+
+    kernels.cos_i16(angles.data(), out.data(), angles.size(), angle_bits);
+
+    for (size_t i = 0; i < angles.size(); i++) {
+        CHECK_EQ(out[i], Cos<angle_bits, int16_t>(angles[i]));
+    }
+
+    for (size_t count = 0; count < 40; count++) {
+        std::vector<int16_t> tail(count + 1, 0x5555);
+        kernels.sin_i16(&angles[1000], tail.data(), count, angle_bits);
+
+        for (size_t i = 0; i < count; i++) {
+            CHECK_EQ(tail[i], Sin<angle_bits, int16_t>(angles[1000 + i]));
+        }
+
+        CHECK_EQ(tail[count], 0x5555);
+    }
+}
+
+// Every input of every width
+static void CheckSqrtFloorKernels(const BatchKernels& kernels) {
+    std::vector<uint8_t> numbers8(256);
+    std::vector<uint8_t> roots8(256);
+
+    for (size_t i = 0; i < numbers8.size(); i++) {
+        numbers8[i] = (uint8_t) (i * 167);
+    }
+
+    kernels.sqrt_u8(numbers8.data(), roots8.data(), numbers8.size());
+
+    for (size_t i = 0; i < numbers8.size(); i++) {
+        CHECK_EQ(roots8[i], SqrtFloorU8(numbers8[i]));
+    }
+
+    std::vector<uint16_t> numbers16(65536);
+    std::vector<uint8_t> roots16(numbers16.size());
+
+    for (size_t i = 0; i < numbers16.size(); i++) {
+        numbers16[i] = (uint16_t) (i * 40503);
+    }
+
+    kernels.sqrt_u16(numbers16.data(), roots16.data(), numbers16.size());
+
+    for (size_t i = 0; i < numbers16.size(); i++) {
+        CHECK_EQ(roots16[i], SqrtFloorU16(numbers16[i]));
+    }
+
+    std::vector<uint32_t> numbers24(1 << 24);
+    std::vector<uint16_t> roots24(numbers24.size());
+
+    for (size_t i = 0; i < numbers24.size(); i++) {
+        numbers24[i] = (uint32_t) i;
+    }
+
+    kernels.sqrt_u24(numbers24.data(), roots24.data(), numbers24.size());
+    size_t num_wrong = 0;
+
+    for (size_t i = 0; i < numbers24.size(); i++) {
+        num_wrong += (roots24[i] != SqrtFloorU24(numbers24[i]));
+    }
+
+    CHECK_EQ(num_wrong, 0);
+
+    // the tails, which are padded out differently
+    for (size_t count = 0; count < 40; count++) {
+        std::vector<uint16_t> tail(count + 1, 0x5555);
+        kernels.sqrt_u24(&numbers24[12345678], tail.data(), count);
+
+        for (size_t i = 0; i < count; i++) {
+            CHECK_EQ(tail[i], SqrtFloorU24(numbers24[12345678 + i]));
+        }
+
+        CHECK_EQ(tail[count], 0x5555);
+    }
+}
+
+static void CheckRotateKernels(const BatchKernels& kernels, const std::vector<uint32_t>& inputs) {
+    // coordinates up to +/-2**30, so that the results cannot overflow
+    std::vector<int32_t> xs, ys;
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        xs.push_back((int32_t) inputs[i] >> 1);
+        ys.push_back((int32_t) inputs[inputs.size() - 1 - i] >> 1);
+    }
+
+    std::vector<int32_t> angles(inputs.begin(), inputs.end());
+    std::vector<int32_t> out_x(xs.size());
+    std::vector<int32_t> out_y(xs.size());
+
+    for (int32_t angle : {0, 1, 1000, 1024, 2500, -7}) {
+        int32_t cos = Cos<12, int32_t>(angle);
+        int32_t sin = Sin<12, int32_t>(angle);
+
+        kernels.rotate2d(xs.data(), ys.data(), out_x.data(), out_y.data(), xs.size(), cos, sin);
+
+        for (size_t i = 0; i < xs.size(); i++) {
+            CHECK_EQ(out_x[i], RotateX(xs[i], ys[i], cos, sin));
+            CHECK_EQ(out_y[i], RotateY(xs[i], ys[i], cos, sin));
+        }
+    }
+
+    kernels.rotate2d_per_point(xs.data(), ys.data(), angles.data(), out_x.data(), out_y.data(), xs.size(), 16);
+
+    for (size_t i = 0; i < xs.size(); i++) {
+        CHECK_EQ(out_x[i], RotateX(xs[i], ys[i], Cos<16, int32_t>(angles[i]), Sin<16, int32_t>(angles[i])));
+        CHECK_EQ(out_y[i], RotateY(xs[i], ys[i], Cos<16, int32_t>(angles[i]), Sin<16, int32_t>(angles[i])));
+    }
+}
+
+static void CheckSinSweepKernels(const BatchKernels& kernels) {
+    // a tone, slow and fast chirps in both directions, and an accumulator that wraps around on every sample
+    const uint32_t sweeps[][3] = {
+            {0, 0x01000000, 0},
+            {0x40000000, 12345, 17},
+            {0xfffff000, 0x7fffffff, UINT32_C(0) - 99991},
+            {123, 0xdeadbeef, 0x10001},
+    };
+
+    std::vector<int32_t> out(1003);
+
+    for (const auto& sweep : sweeps) {
+        kernels.sin_sweep(out.data(), out.size(), sweep[0], sweep[1], sweep[2], 16);
+
+        uint32_t phase = sweep[0];
+        uint32_t step = sweep[1];
+
+        for (size_t i = 0; i < out.size(); i++) {
+            CHECK_EQ(out[i], Sin<16, int32_t>((int32_t) (phase >> 16)));
+            phase += step;
+            step += sweep[2];
+        }
+    }
+
+    kernels.sin_sweep(out.data(), out.size(), 0x87654321, 0x00100000, 3, 30);
+
+    std::vector<int32_t> expected(out.size());
+
+    for (size_t i = 0; i < out.size(); i++) {
+        uint32_t phase = 0x87654321 + (uint32_t) i * 0x00100000 + (uint32_t) (i * (i - 1) / 2) * 3;
+        expected[i] = Sin<30, int32_t>((int32_t) (phase >> 2));
+    }
+
+    for (size_t i = 0; i < out.size(); i++) {
+        CHECK_EQ(out[i], expected[i]);
+    }
+}
+
+static void CheckArithKernels(const BatchKernels& kernels, const std::vector<uint32_t>& inputs) {
+    // every pair of the extremes, a run of INT_MIN * INT_MIN to overflow the pairwise 16-bit products, then the
+    // random inputs, which leave a tail as in BatchTestInputs
+    const int32_t extremes[] = {INT32_MIN, INT32_MIN + 1, -0x40000000, -1, 0, 1, 0x40000000, INT32_MAX - 1, INT32_MAX};
+    const int16_t extremes16[] = {INT16_MIN, INT16_MIN + 1, -0x4000, -1, 0, 1, 0x4000, INT16_MAX - 1, INT16_MAX};
+    std::vector<int32_t> a32, b32;
+    std::vector<int16_t> a16, b16;
+
+    for (int i = 0; i < 64; i++) {
+        a32.push_back(INT32_MIN);
+        b32.push_back(INT32_MIN);
+        a16.push_back(INT16_MIN);
+        b16.push_back(INT16_MIN);
+    }
+
+    for (size_t i = 0; i < 9 * 9; i++) {
+        a32.push_back(extremes[i / 9]);
+        b32.push_back(extremes[i % 9]);
+        a16.push_back(extremes16[i / 9]);
+        b16.push_back(extremes16[i % 9]);
+    }
+
+    for (size_t i = 0; i < inputs.size(); i++) {
+        a32.push_back((int32_t) inputs[i]);
+        b32.push_back((int32_t) inputs[inputs.size() - 1 - i]);
+        a16.push_back((int16_t) inputs[i]);
+        b16.push_back((int16_t) (inputs[i] >> 16));
+    }
+
+    const size_t count = a32.size();
+    std::vector<int32_t> out32(count);
+    std::vector<int16_t> out16(count);
+
+    kernels.add_sat16(a16.data(), b16.data(), out16.data(), count);
+    for (size_t i = 0; i < count; i++) { CHECK_EQ(out16[i], AddSat16(a16[i], b16[i])); }
+
+    kernels.sub_sat16(a16.data(), b16.data(), out16.data(), count);
+    for (size_t i = 0; i < count; i++) { CHECK_EQ(out16[i], SubSat16(a16[i], b16[i])); }
+
+    kernels.mulh_round15(a16.data(), b16.data(), out16.data(), count);
+    for (size_t i = 0; i < count; i++) { CHECK_EQ(out16[i], MulhRound15(a16[i], b16[i])); }
+
+    kernels.add_sat32(a32.data(), b32.data(), out32.data(), count);
+    for (size_t i = 0; i < count; i++) { CHECK_EQ(out32[i], AddSat32(a32[i], b32[i])); }
+
+    kernels.sub_sat32(a32.data(), b32.data(), out32.data(), count);
+    for (size_t i = 0; i < count; i++) { CHECK_EQ(out32[i], SubSat32(a32[i], b32[i])); }
+
+    kernels.mulh_round31(a32.data(), b32.data(), out32.data(), count);
+    for (size_t i = 0; i < count; i++) { CHECK_EQ(out32[i], MulhRound31(a32[i], b32[i])); }
+
+    // short runs of the extremes, down to a single 16-bit element in a lane, without writing past the end
+    for (size_t n = 0; n < 40; n++) {
+        std::vector<int16_t> short16(n + 1, 0x5a5a);
+        std::vector<int32_t> short32(n + 1, 0x5a5a5a5a);
+
+        kernels.mulh_round15(&a16[64], &b16[64], short16.data(), n);
+        kernels.mulh_round31(&a32[64], &b32[64], short32.data(), n);
+
+        for (size_t i = 0; i < n; i++) {
+            CHECK_EQ(short16[i], MulhRound15(a16[64 + i], b16[64 + i]));
+            CHECK_EQ(short32[i], MulhRound31(a32[64 + i], b32[64 + i]));
+        }
+
+        CHECK_EQ(short16[n], 0x5a5a);
+        CHECK_EQ(short32[n], 0x5a5a5a5a);
+    }
+
+    // every prefix of the overflowing run and the extremes, then everything
+    int64_t expected15 = 7;
+    int64_t expected31 = -7;
+
+    for (size_t i = 0; i <= count; i++) {
+        if (i <= 64 + 9 * 9 || i == count) {
+            CHECK_EQ(kernels.mac_q15(7, a16.data(), b16.data(), i), expected15);
+            CHECK_EQ(kernels.mac_q31(-7, a32.data(), b32.data(), i), expected31);
+        }
+
+        if (i < count) {
+            expected15 += (int64_t) a16[i] * b16[i];
+            expected31 += (int64_t) a32[i] * b32[i];
+        }
+    }
+}
+
+TEST_CASE("Batch kernels match scalar functions") {
+    auto inputs = BatchTestInputs();
+
+    for (int i = 0; i < NUM_ISAS; i++) {
+        auto kernels = GetBatchKernels((Isa) i);
+
+        if (!kernels) {
+            continue;
+        }
+
+        INFO("instruction set: " << IsaName((Isa) i));
+
+        std::vector<int32_t> out(inputs.size());
+
+        kernels->log2floor(inputs.data(), out.data(), inputs.size());
+
+        for (size_t j = 0; j < inputs.size(); j++) {
+            CHECK_EQ(out[j], Log2floor(inputs[j]));
+        }
+
+        kernels->log2ceil(inputs.data(), out.data(), inputs.size());
+
+        for (size_t j = 0; j < inputs.size(); j++) {
+            CHECK_EQ(out[j], Log2ceil(inputs[j]));
+        }
+
+        CheckSqrtuKernel<6, 10>(*kernels, inputs);
+        CheckSqrtuKernel<2, 3>(*kernels, inputs);
+        CheckSqrtuKernel<16, 20>(*kernels, inputs);
+
+        CheckSinCosKernels<SIN_TABLE_BITS + 2>(*kernels, inputs);
+        CheckSinCosKernels<12>(*kernels, inputs);
+        CheckSinCosKernels<16>(*kernels, inputs);
+        CheckSinCosKernels<MAX_BATCH_ANGLE_BITS>(*kernels, inputs);
+
+        CheckSinCosI16Kernels<SIN_TABLE_BITS + 2>(*kernels);
+        CheckSinCosI16Kernels<12>(*kernels);
+        CheckSinCosI16Kernels<15>(*kernels);
+        CheckSinCosI16Kernels<16>(*kernels);
+
+        CheckSqrtFloorKernels(*kernels);
+
+        CheckRotateKernels(*kernels, inputs);
+        CheckSinSweepKernels(*kernels);
+        CheckArithKernels(*kernels, inputs);
+
+        // the tail is computed separately from the vectorized part
+        for (size_t count = 0; count < 20; count++) {
+            std::vector<uint32_t> sqrt_out(count + 1, 0xdeadbeef);
+            kernels->sqrtu(inputs.data(), sqrt_out.data(), count, 6, 10);
+
+            CHECK_EQ(sqrt_out[count], 0xdeadbeef);
+        }
+    }
+}
+
+TEST_CASE("Batch entry points") {
+    CHECK_NE(GetBatchKernels(Isa::scalar), nullptr);
+    CHECK_EQ(&GetBatchKernels(), GetBatchKernels(GetSelectedIsa()));
+
+    uint32_t numbers[] = {0, 1, 2, 100, 65536, UINT32_MAX};
+    uint32_t roots[6];
+    int32_t log2s[6];
+
+    SqrtuBatch(numbers, roots, 6);
+    CHECK_EQ(roots[3], Sqrtu(100));
+    CHECK_EQ(roots[5], Sqrtu(UINT32_MAX));
+
+    uint8_t numbers8[] = {0, 1, 3, 4, 255};
+    uint16_t numbers16[] = {0, 2, 65535};
+    uint32_t numbers24[] = {0, 16769025, 16777215};
+    uint8_t roots8[5];
+    uint16_t roots24[3];
+
+    SqrtBatchU8(numbers8, roots8, 5);
+    CHECK_EQ(roots8[2], 1);
+    CHECK_EQ(roots8[4], 15);
+
+    SqrtBatchU16(numbers16, roots8, 3);
+    CHECK_EQ(roots8[1], 1);
+    CHECK_EQ(roots8[2], 255);
+
+    SqrtBatchU24(numbers24, roots24, 3);
+    CHECK_EQ(roots24[1], 4095);
+    CHECK_EQ(roots24[2], 4095);
+
+    Log2floorBatch(numbers, log2s, 6);
+    CHECK_EQ(log2s[0], -1);
+    CHECK_EQ(log2s[4], 16);
+
+    Log2ceilBatch(numbers, log2s, 6);
+    CHECK_EQ(log2s[0], -1);
+    CHECK_EQ(log2s[5], 32);
+
+    int32_t angles[] = {0, 1024, 2048, 3072, -1};
+    int32_t sines[5];
+
+    SinBatch<12>(angles, sines, 5);
+    CHECK_EQ(sines[1], 4096);
+    CHECK_EQ(sines[3], -4096);
+
+    CosBatch<12>(angles, sines, 5);
+    CHECK_EQ(sines[0], 4096);
+    CHECK_EQ(sines[2], -4096);
+
+    int16_t angles16[] = {0, 16384, -32768, -16384, -1};
+    int16_t sines16[5];
+
+    SinBatchI16<16>(angles16, sines16, 5);
+    CHECK_EQ(sines16[1], 4096);
+    CHECK_EQ(sines16[3], -4096);
+
+    CosBatchI16<16>(angles16, sines16, 5);
+    CHECK_EQ(sines16[0], 4096);
+    CHECK_EQ(sines16[2], -4096);
+
+    SinDeltaBatch<12>(angles, sines, 5);
+    CHECK_EQ(sines[1], 4096);
+    CHECK_EQ(sines[4], Sin<12, int32_t>(-1));
+}
@@ -0,0 +1,68 @@
+#ifndef FIXED_POINT_MATH_DISPATCH_HPP
+#define FIXED_POINT_MATH_DISPATCH_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Run-time selection of batch kernels.
+//
+// The CPU is queried once, on first use, and the best instruction set that is both supported and compiled in is
+// selected. Setting the environment variable FIXED_POINT_MATH_ISA to one of "scalar", "sse4.2", "avx2" or "avx512"
+// caps the selection at that level, which is useful for benchmarking the individual paths.
+
+enum class Isa {
+    scalar,
+    sse42,
+    avx2,
+    avx512,     // F + CD + BW + DQ + VL
+};
+
+constexpr int NUM_ISAS = 4;
+
+// All kernels produce results bit-identical to the scalar functions they vectorize
+struct BatchKernels {
+    void (*sqrtu)(const uint32_t* numbers, uint32_t* out, size_t count, int tolerance_bits, int max_iterations);
+    void (*log2floor)(const uint32_t* values, int32_t* out, size_t count);
+    void (*log2ceil)(const uint32_t* values, int32_t* out, size_t count);
+    void (*sin)(const int32_t* angles, int32_t* out, size_t count, int angle_bits);
+    void (*cos)(const int32_t* angles, int32_t* out, size_t count, int angle_bits);
+    void (*rotate2d)(const int32_t* xs, const int32_t* ys, int32_t* out_x, int32_t* out_y, size_t count,
+                     int32_t cos, int32_t sin);
+    void (*rotate2d_per_point)(const int32_t* xs, const int32_t* ys, const int32_t* angles, int32_t* out_x,
+                               int32_t* out_y, size_t count, int angle_bits);
+    // Sin of a phase accumulator with 2**32 units per turn, truncated to angle_bits: sample i is taken at
+    // phase + i step + i (i - 1) / 2 step_delta, modulo 2**32
+    void (*sin_sweep)(int32_t* out, size_t count, uint32_t phase, uint32_t step, uint32_t step_delta, int angle_bits);
+    // sin from sin_delta_table_v<SIN_TABLE_BITS>, decoded per lane as SinDelta does
+    void (*sin_delta)(const int32_t* angles, int32_t* out, size_t count, int angle_bits);
+    // Sin and Cos of int16_t angles, for angle_bits up to 16; the results always fit in int16_t
+    void (*sin_i16)(const int16_t* angles, int16_t* out, size_t count, int angle_bits);
+    void (*cos_i16)(const int16_t* angles, int16_t* out, size_t count, int angle_bits);
+    // floor(sqrt(number)), exactly, for numbers of 8, 16 and 24 bits; the last must be below 2**24
+    void (*sqrt_u8)(const uint8_t* numbers, uint8_t* out, size_t count);
+    void (*sqrt_u16)(const uint16_t* numbers, uint8_t* out, size_t count);
+    void (*sqrt_u24)(const uint32_t* numbers, uint16_t* out, size_t count);
+    // The batch forms of arith.hpp
+    void (*add_sat16)(const int16_t* a, const int16_t* b, int16_t* out, size_t count);
+    void (*sub_sat16)(const int16_t* a, const int16_t* b, int16_t* out, size_t count);
+    void (*add_sat32)(const int32_t* a, const int32_t* b, int32_t* out, size_t count);
+    void (*sub_sat32)(const int32_t* a, const int32_t* b, int32_t* out, size_t count);
+    void (*mulh_round15)(const int16_t* a, const int16_t* b, int16_t* out, size_t count);
+    void (*mulh_round31)(const int32_t* a, const int32_t* b, int32_t* out, size_t count);
+    int64_t (*mac_q15)(int64_t acc, const int16_t* a, const int16_t* b, size_t count);
+    int64_t (*mac_q31)(int64_t acc, const int32_t* a, const int32_t* b, size_t count);
+};
+
+const char* IsaName(Isa isa);
+
+// Best instruction set supported by the CPU, regardless of what is compiled in or requested
+Isa DetectIsa();
+
+// Kernels for the selected instruction set
+const BatchKernels& GetBatchKernels();
+Isa GetSelectedIsa();
+
+// Kernels for a specific instruction set, or nullptr if the CPU does not support it
+const BatchKernels* GetBatchKernels(Isa isa);
+
+#endif
@@ -0,0 +1,341 @@
+#include "fft.hpp"
+#include "arith.hpp"
+
+#include <doctest.h>
+
+#include <assert.h>
+#include <math.h>
+
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Products and butterfly sums are formed at twice the sample width
+template <typename Sample_t>
+using FftWide_t = std::conditional_t<sizeof(Sample_t) == 2, int32_t, int64_t>;
+
+template <typename Sample_t>
+constexpr int fft_frac_bits = (int) sizeof(Sample_t) * 8 - 1;
+
+template <typename Sample_t>
+Fft<Sample_t>::Fft(int log2_size)
+        : log2_size(log2_size), size((size_t) 1 << log2_size), quarter_sin(((size_t) 1 << log2_size) / 4 + 1) {
+    assert(log2_size >= 2 && log2_size <= FFT_MAX_LOG2_SIZE);
+
+    // sin(pi/2) = 1 is not representable and is stored as the largest sample value
+    const double one = ldexp(1.0, fft_frac_bits<Sample_t>);
+    const double max = one - 1;
+
+    for (size_t k = 0; k < quarter_sin.size(); k++) {
+        quarter_sin[k] = (Sample_t) fmin(round(sin(2 * M_PI * (double) k / (double) size) * one), max);
+    }
+}
+
+template <typename Sample_t>
+Sample_t Fft<Sample_t>::SinAt(size_t k) const {
+    const size_t quarter = size / 4;
+
+    size_t index = k & (quarter - 1);
+
+    // 2nd or 4th quarter: mirror
+    if ((k & quarter) != 0) {
+        index = quarter - index;
+    }
+
+    // 3rd or 4th quarter: negate
+    return (k & (size / 2)) == 0 ? quarter_sin[index] : (Sample_t) -quarter_sin[index];
+}
+
+template <typename Sample_t>
+Complex<Sample_t> Fft<Sample_t>::Twiddle(size_t k) const {
+    return {SinAt(k + size / 4), (Sample_t) -SinAt(k)};
+}
+
+template <typename Sample_t>
+static void BitReverse(Complex<Sample_t>* data, size_t size) {
+    for (size_t i = 0, j = 0; i < size; i++) {
+        if (i < j) {
+            std::swap(data[i], data[j]);
+        }
+
+        // increment j with the bits reversed
+        size_t bit = size >> 1;
+
+        while (j & bit) {
+            j ^= bit;
+            bit >>= 1;
+        }
+
+        j |= bit;
+    }
+}
+
+// Shifts the block right just far enough for every component to stay below 2**(frac_bits - headroom_bits),
+// and returns the shift
+template <typename Sample_t>
+static int Rescale(Complex<Sample_t>* data, size_t size, int headroom_bits) {
+    using Wide_t = FftWide_t<Sample_t>;
+
+    const Wide_t limit = (Wide_t) 1 << (fft_frac_bits<Sample_t> - headroom_bits);
+
+    Wide_t max = 0;
+
+    for (size_t i = 0; i < size; i++) {
+        Wide_t re = data[i].re;
+        Wide_t im = data[i].im;
+        max = std::max(max, std::max(re < 0 ? -re : re, im < 0 ? -im : im));
+    }
+
+    int shift = 0;
+
+    while (((max + ((Wide_t) 1 << shift >> 1)) >> shift) >= limit) {
+        shift++;
+    }
+
+    if (shift > 0) {
+        const Wide_t round = (Wide_t) 1 << (shift - 1);
+
+        for (size_t i = 0; i < size; i++) {
+            data[i].re = (Sample_t) (((Wide_t) data[i].re + round) >> shift);
+            data[i].im = (Sample_t) (((Wide_t) data[i].im + round) >> shift);
+        }
+    }
+
+    return shift;
+}
+
+template <typename Sample_t>
+static Complex<FftWide_t<Sample_t>> Multiply(Complex<Sample_t> x, Complex<Sample_t> w) {
+    using Wide_t = FftWide_t<Sample_t>;
+    constexpr int frac_bits = fft_frac_bits<Sample_t>;
+
+    return {ShiftRound<frac_bits>((Wide_t) x.re * w.re - (Wide_t) x.im * w.im),
+            ShiftRound<frac_bits>((Wide_t) x.re * w.im + (Wide_t) x.im * w.re)};
+}
+
+template <typename Sample_t>
+int Fft<Sample_t>::Transform(Complex<Sample_t>* data, bool inverse) const {
+    using Wide_t = FftWide_t<Sample_t>;
+
+    BitReverse(data, size);
+
+    int exponent = 0;
+    size_t q = 1;
+
+    if (log2_size % 2 != 0) {
+        // radix-2 stage; the twiddle factor is always 1
+        exponent += Rescale(data, size, 1);
+
+        for (size_t i = 0; i < size; i += 2) {
+            Complex<Sample_t> a = data[i];
+            Complex<Sample_t> b = data[i + 1];
+
+            data[i] = {(Sample_t) (a.re + b.re), (Sample_t) (a.im + b.im)};
+            data[i + 1] = {(Sample_t) (a.re - b.re), (Sample_t) (a.im - b.im)};
+        }
+
+        q = 2;
+    }
+
+    // Radix-4 stages, each doing the work of two radix-2 stages on blocks of 4q elements. A component can grow by
+    // at most 1 + 3 sqrt(2) < 8.
+    for (; q < size; q *= 4) {
+        exponent += Rescale(data, size, 3);
+
+        const size_t twiddle_step = size / (4 * q);
+
+        for (size_t j = 0; j < q; j++) {
+            Complex<Sample_t> w1 = Twiddle(j * twiddle_step);
+            Complex<Sample_t> w2 = Twiddle(2 * j * twiddle_step);
+            Complex<Sample_t> w3 = Twiddle(3 * j * twiddle_step);
+
+            if (inverse) {
+                w1.im = (Sample_t) -w1.im;
+                w2.im = (Sample_t) -w2.im;
+                w3.im = (Sample_t) -w3.im;
+            }
+
+            for (size_t block = 0; block < size; block += 4 * q) {
+                Complex<Sample_t>* x = &data[block + j];
+
+                Complex<Wide_t> a = {x[0].re, x[0].im};
+                Complex<Wide_t> b = Multiply(x[q], w2);
+                Complex<Wide_t> c = Multiply(x[2 * q], w1);
+                Complex<Wide_t> d = Multiply(x[3 * q], w3);
+
+                Complex<Wide_t> sum_ab = {a.re + b.re, a.im + b.im};
+                Complex<Wide_t> diff_ab = {a.re - b.re, a.im - b.im};
+                Complex<Wide_t> sum_cd = {c.re + d.re, c.im + d.im};
+
+                // (c - d) rotated by a quarter turn: -i for the forward transform, +i for the inverse
+                Complex<Wide_t> rot_cd = inverse ? Complex<Wide_t>{d.im - c.im, c.re - d.re}
+                                                 : Complex<Wide_t>{c.im - d.im, d.re - c.re};
+
+                x[0] = {(Sample_t) (sum_ab.re + sum_cd.re), (Sample_t) (sum_ab.im + sum_cd.im)};
+                x[q] = {(Sample_t) (diff_ab.re + rot_cd.re), (Sample_t) (diff_ab.im + rot_cd.im)};
+                x[2 * q] = {(Sample_t) (sum_ab.re - sum_cd.re), (Sample_t) (sum_ab.im - sum_cd.im)};
+                x[3 * q] = {(Sample_t) (diff_ab.re - rot_cd.re), (Sample_t) (diff_ab.im - rot_cd.im)};
+            }
+        }
+    }
+
+    return exponent;
+}
+
+template <typename Sample_t>
+int Fft<Sample_t>::Forward(Complex<Sample_t>* data) const {
+    return Transform(data, false);
+}
+
+template <typename Sample_t>
+int Fft<Sample_t>::Inverse(Complex<Sample_t>* data) const {
+    return Transform(data, true);
+}
+
+template class Fft<int16_t>;
+template class Fft<int32_t>;
+
+// Random samples of the given magnitude, from the same kind of generator as the batch tests
+template <typename Sample_t>
+static std::vector<Complex<Sample_t>> FftTestInput(size_t size, int magnitude_bits, uint32_t seed) {
+    std::vector<Complex<Sample_t>> data(size);
+    uint32_t state = seed;
+
+    auto next = [&]() {
+        state = state * 1664525 + 1013904223;
+        return (Sample_t) ((int32_t) state >> (32 - magnitude_bits));
+    };
+
+    for (auto& sample : data) {
+        sample.re = next();
+        sample.im = next();
+    }
+
+    return data;
+}
+
+// Signal to error ratio, in dB, of a transform with its block exponent against the direct DFT computed in double
+template <typename Sample_t>
+static double FftSnr(const std::vector<Complex<Sample_t>>& input, const std::vector<Complex<Sample_t>>& output,
+                     int exponent, bool inverse) {
+    const size_t size = input.size();
+    const double sign = inverse ? 1 : -1;
+    double signal = 0;
+    double error = 0;
+
+    for (size_t k = 0; k < size; k++) {
+        double re = 0;
+        double im = 0;
+
+        for (size_t n = 0; n < size; n++) {
+            double phase = sign * 2 * M_PI * (double) ((k * n) % size) / (double) size;
+            re += input[n].re * cos(phase) - input[n].im * sin(phase);
+            im += input[n].re * sin(phase) + input[n].im * cos(phase);
+        }
+
+        double got_re = ldexp(output[k].re, exponent);
+        double got_im = ldexp(output[k].im, exponent);
+
+        signal += re * re + im * im;
+        error += (got_re - re) * (got_re - re) + (got_im - im) * (got_im - im);
+    }
+
+    return 10 * log10(signal / error);
+}
+
+template <typename Sample_t>
+static double FftWorstSnr(int min_log2_size, int max_log2_size, bool inverse) {
+    double worst = INFINITY;
+
+    for (int log2_size = min_log2_size; log2_size <= max_log2_size; log2_size++) {
+        Fft<Sample_t> fft(log2_size);
+
+        auto input = FftTestInput<Sample_t>(fft.GetSize(), (int) sizeof(Sample_t) * 8, (uint32_t) log2_size);
+        auto output = input;
+        int exponent = inverse ? fft.Inverse(output.data()) : fft.Forward(output.data());
+
+        worst = fmin(worst, FftSnr(input, output, exponent, inverse));
+    }
+
+    return worst;
+}
+
+TEST_CASE("Fft::Twiddle") {
+    FftQ15 fft15(10);
+    FftQ31 fft31(10);
+
+    CHECK_EQ(fft15.Twiddle(0).re, 32767);
+    CHECK_EQ(fft15.Twiddle(0).im, 0);
+    CHECK_EQ(fft15.Twiddle(256).re, 0);
+    CHECK_EQ(fft15.Twiddle(256).im, -32767);
+    CHECK_EQ(fft15.Twiddle(512).re, -32767);
+    CHECK_EQ(fft31.Twiddle(768).im, INT32_MAX);
+
+    for (size_t k = 0; k < 2048; k++) {
+        double phase = -2 * M_PI * (double) k / 1024;
+
+        REQUIRE_LE(fabs(fft15.Twiddle(k).re - cos(phase) * 32768), 1);
+        REQUIRE_LE(fabs(fft15.Twiddle(k).im - sin(phase) * 32768), 1);
+        REQUIRE_LE(fabs(fft31.Twiddle(k).re - ldexp(cos(phase), 31)), 1);
+        REQUIRE_LE(fabs(fft31.Twiddle(k).im - ldexp(sin(phase), 31)), 1);
+    }
+}
+
+TEST_CASE("Fft::Forward, Fft::Inverse") {
+    // full-scale random input, every size up to 2048 points; the error grows by about 1.5 dB per doubling
+    CHECK_GE(FftWorstSnr<int16_t>(2, 11, false), 57);
+    CHECK_GE(FftWorstSnr<int16_t>(2, 11, true), 57);
+    CHECK_GE(FftWorstSnr<int32_t>(2, 11, false), 150);
+    CHECK_GE(FftWorstSnr<int32_t>(2, 11, true), 150);
+}
+
+TEST_CASE("Fft: special inputs") {
+    for (int log2_size = 2; log2_size <= 10; log2_size++) {
+        FftQ15 fft(log2_size);
+        const size_t size = fft.GetSize();
+
+        // an impulse that leaves enough headroom gives a flat spectrum, exactly and without scaling
+        std::vector<ComplexQ15> data(size, ComplexQ15{0, 0});
+        data[0] = {1000, -1000};
+        REQUIRE_EQ(fft.Forward(data.data()), 0);
+
+        for (const auto& bin : data) {
+            REQUIRE_EQ(bin.re, 1000);
+            REQUIRE_EQ(bin.im, -1000);
+        }
+
+        // the most negative constant input must not overflow anywhere
+        std::fill(data.begin(), data.end(), ComplexQ15{INT16_MIN, INT16_MIN});
+        int exponent = fft.Forward(data.data());
+
+        REQUIRE_EQ(ldexp(data[0].re, exponent), -32768.0 * (double) size);
+        REQUIRE_EQ(ldexp(data[0].im, exponent), -32768.0 * (double) size);
+
+        for (size_t k = 1; k < size; k++) {
+            REQUIRE_EQ(data[k].re, 0);
+            REQUIRE_EQ(data[k].im, 0);
+        }
+    }
+}
+
+TEST_CASE("Fft: round trip") {
+    // Inverse(Forward(x)) = N x
+    for (int log2_size = 2; log2_size <= 16; log2_size++) {
+        FftQ31 fft(log2_size);
+
+        auto input = FftTestInput<int32_t>(fft.GetSize(), 32, 1);
+        auto data = input;
+        int exponent = fft.Forward(data.data());
+        exponent += fft.Inverse(data.data());
+
+        double max_error = 0;
+
+        for (size_t n = 0; n < fft.GetSize(); n++) {
+            max_error = fmax(max_error, fabs(ldexp(data[n].re, exponent - log2_size) - input[n].re));
+            max_error = fmax(max_error, fabs(ldexp(data[n].im, exponent - log2_size) - input[n].im));
+        }
+
+        // the error, about 2**-19 of full scale at 2**16 points, grows with sqrt(N)
+        REQUIRE_LE(max_error, exp2(log2_size / 2.0 + 6));
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef FIXED_POINT_MATH_FFT_HPP
+#define FIXED_POINT_MATH_FFT_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+// In-place fixed-point FFT on complex Q15 (int16_t) or Q31 (int32_t) samples.
+//
+// Twiddle factors are taken from a quarter-wave table of sin, N/4 + 1 entries, folded the same way as Sin folds
+// sin_table; there is no full-length table. Lengths are powers of two, transformed in radix-4 stages on
+// bit-reversed data, preceded by a single radix-2 stage for odd powers.
+//
+// Scaling is block floating point: before each stage the largest component is checked, and the whole block is
+// shifted right only as far as needed to rule out overflow in that stage. The accumulated shift is returned as the
+// block exponent, so the exact transform is data * 2**exponent.
+
+constexpr int FFT_MAX_LOG2_SIZE = 20;
+
+template <typename T>
+struct Complex {
+    T re;
+    T im;
+};
+
+template <typename Sample_t>
+class Fft {
+public:
+    // log2_size must be between 2 and FFT_MAX_LOG2_SIZE
+    explicit Fft(int log2_size);
+
+    int GetLog2Size() const { return log2_size; }
+    size_t GetSize() const { return size; }
+
+    // exp(-2 pi i k / N), for any k
+    Complex<Sample_t> Twiddle(size_t k) const;
+
+    // Both return the block exponent. The inverse transform is not divided by N.
+    int Forward(Complex<Sample_t>* data) const;
+    int Inverse(Complex<Sample_t>* data) const;
+
+private:
+    Sample_t SinAt(size_t k) const;
+    int Transform(Complex<Sample_t>* data, bool inverse) const;
+
+    int log2_size;
+    size_t size;
+    std::vector<Sample_t> quarter_sin;      // sin(2 pi k / N) for k in [0, N/4]
+};
+
+using ComplexQ15 = Complex<int16_t>;
+using ComplexQ31 = Complex<int32_t>;
+using FftQ15 = Fft<int16_t>;
+using FftQ31 = Fft<int32_t>;
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef FIXED_POINT_MATH_HPP
+#define FIXED_POINT_MATH_HPP
+
+// All scalar functions in one include.
+//
+// With FIXED_POINT_MATH_HEADER_ONLY defined, everything declared here is inline or constexpr, tables included, so
+// the compiler can inline it into tight loops without LTO and there is no library to link. The
+// Fixed_Point_Math_Header_Only target defines the macro for everything that links it; it must not differ between
+// the translation units of one program.
+//
+// The batch kernels, FFT, DDS and rotations need run-time dispatch and code compiled per instruction set, so they
+// are only available from the Fixed_Point_Math library.
+
+#include "arith.hpp"
+#include "asin_acos.hpp"
+#include "log2.hpp"
+#include "policy.hpp"
+#include "sin_cos.hpp"
+#include "sin_table.hpp"
+#include "sqrt.hpp"
+#include "tan.hpp"
+
+#endif
@@ -0,0 +1,166 @@
+#include "instrument.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string.h>
+
+namespace {
+
+// Only the owning thread writes its counters, so a relaxed load and store are enough; they are atomic only so that
+// snapshots can read them at the same time.
+struct ThreadCounters {
+    std::atomic<uint64_t> calls[INSTRUMENT_MAX_SITES];
+    std::atomic<uint64_t> iteration_limit_hits[INSTRUMENT_MAX_SITES];
+    std::atomic<uint64_t> iterations[INSTRUMENT_MAX_SITES][INSTRUMENT_ITERATION_BUCKETS];
+
+    ThreadCounters();
+    ~ThreadCounters();
+
+    static void Increment(std::atomic<uint64_t>& counter) {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+};
+
+struct Registry {
+    std::mutex mutex;
+    int num_sites = 0;
+    char names[INSTRUMENT_MAX_SITES][sizeof(InstrumentSite::name)] = {};
+
+    std::vector<ThreadCounters*> threads;
+    InstrumentSite exited[INSTRUMENT_MAX_SITES] = {};    // totals of the threads that have exited
+
+    // Adds the counts of one thread; the caller holds the mutex
+    void Accumulate(const ThreadCounters& counters, InstrumentSite* sites, int count) const {
+        for (int site = 0; site < count; site++) {
+            sites[site].calls += counters.calls[site].load(std::memory_order_relaxed);
+            sites[site].iteration_limit_hits += counters.iteration_limit_hits[site].load(std::memory_order_relaxed);
+
+            for (int bucket = 0; bucket < INSTRUMENT_ITERATION_BUCKETS; bucket++) {
+                sites[site].iterations[bucket] += counters.iterations[site][bucket].load(std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+// Never destroyed, so that threads which exit during static destruction can still hand in their counts
+Registry& GetRegistry() {
+    static Registry* registry = new Registry;
+    return *registry;
+}
+
+ThreadCounters::ThreadCounters() {
+    for (int site = 0; site < INSTRUMENT_MAX_SITES; site++) {
+        calls[site].store(0, std::memory_order_relaxed);
+        iteration_limit_hits[site].store(0, std::memory_order_relaxed);
+
+        for (auto& bucket : iterations[site]) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.threads.push_back(this);
+}
+
+ThreadCounters::~ThreadCounters() {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+
+    registry.Accumulate(*this, registry.exited, INSTRUMENT_MAX_SITES);
+    registry.threads.erase(std::find(registry.threads.begin(), registry.threads.end(), this));
+}
+
+ThreadCounters& GetThreadCounters() {
+    thread_local ThreadCounters counters;
+    return counters;
+}
+
+}
+
+int RegisterInstrumentSite(const char* function, int param_a, int param_b) {
+    char name[sizeof(InstrumentSite::name)];
+
+    if (param_b < 0) {
+        snprintf(name, sizeof(name), "%s<%d>", function, param_a);
+    }
+    else {
+        snprintf(name, sizeof(name), "%s<%d, %d>", function, param_a, param_b);
+    }
+
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    int num_sites = registry.num_sites;
+
+    for (int site = 0; site < num_sites; site++) {
+        if (strcmp(registry.names[site], name) == 0) {
+            return site;
+        }
+    }
+
+    if (num_sites == INSTRUMENT_MAX_SITES) {
+        return INSTRUMENT_MAX_SITES - 1;
+    }
+
+    strcpy(registry.names[num_sites], num_sites == INSTRUMENT_MAX_SITES - 1 ? "(other)" : name);
+    registry.num_sites = num_sites + 1;
+    return num_sites;
+}
+
+void InstrumentCall(int site) {
+    ThreadCounters::Increment(GetThreadCounters().calls[site]);
+}
+
+void InstrumentIterations(int site, int num_iterations, bool hit_limit) {
+    ThreadCounters& counters = GetThreadCounters();
+    int bucket = num_iterations < INSTRUMENT_ITERATION_BUCKETS ? num_iterations : INSTRUMENT_ITERATION_BUCKETS - 1;
+
+    ThreadCounters::Increment(counters.calls[site]);
+    ThreadCounters::Increment(counters.iterations[site][bucket]);
+
+    if (hit_limit) {
+        ThreadCounters::Increment(counters.iteration_limit_hits[site]);
+    }
+}
+
+InstrumentSnapshot GetInstrumentSnapshot() {
+    Registry& registry = GetRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    int num_sites = registry.num_sites;
+
+    InstrumentSnapshot snapshot;
+    snapshot.sites.assign(registry.exited, registry.exited + num_sites);
+
+    for (auto counters : registry.threads) {
+        registry.Accumulate(*counters, snapshot.sites.data(), num_sites);
+    }
+
+    for (int site = 0; site < num_sites; site++) {
+        memcpy(snapshot.sites[site].name, registry.names[site], sizeof(InstrumentSite::name));
+    }
+
+    return snapshot;
+}
+
+void WriteInstrumentCsv(const InstrumentSnapshot& snapshot, FILE* file) {
+    fprintf(file, "site,calls,iteration_limit_hits");
+
+    for (int bucket = 0; bucket < INSTRUMENT_ITERATION_BUCKETS; bucket++) {
+        fprintf(file, ",iterations_%d", bucket);
+    }
+
+    fprintf(file, "\n");
+
+    for (auto const& site : snapshot.sites) {
+        // names contain a comma
+        fprintf(file, "\"%s\",%llu,%llu", site.name, (unsigned long long) site.calls,
+                (unsigned long long) site.iteration_limit_hits);
+
+        for (auto count : site.iterations) {
+            fprintf(file, ",%llu", (unsigned long long) count);
+        }
+
+        fprintf(file, "\n");
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef FIXED_POINT_MATH_INSTRUMENT_HPP
+#define FIXED_POINT_MATH_INSTRUMENT_HPP
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <vector>
+
+// Opt-in call counters for the scalar functions, compiled in only with FIXED_POINT_MATH_INSTRUMENT (the CMake option
+// of the same name defines it for the library and everything that links it). Otherwise the hooks expand to nothing.
+// Like FIXED_POINT_MATH_HEADER_ONLY, it must not differ between the translation units of one program, since the
+// instrumented and the plain scalar templates would be two definitions of the same functions.
+//
+// Counts are kept per site, a function together with its template parameters, e.g. "Sqrtu<6, 10>" or "Sin<16>".
+// A site gets its slot on its first call; after that, every thread counts into slots of its own with plain relaxed
+// loads and stores, without locks or atomic read-modify-writes. Snapshots add up the slots of all threads, including
+// the ones that have exited. Cos and Acos count as the Sin and Asin they call.
+
+constexpr int INSTRUMENT_MAX_SITES = 64;
+
+// Number of bisection steps, the last bucket also counts anything above
+constexpr int INSTRUMENT_ITERATION_BUCKETS = 32;
+
+struct InstrumentSite {
+    char name[32];
+    uint64_t calls;
+    // Sqrtu only: calls that MAX_ITERATIONS stopped before the interval had shrunk to the tolerance
+    uint64_t iteration_limit_hits;
+    // Sqrtu only: calls by number of bisection steps
+    uint64_t iterations[INSTRUMENT_ITERATION_BUCKETS];
+};
+
+struct InstrumentSnapshot {
+    std::vector<InstrumentSite> sites;  // in the order of their first calls
+};
+
+// Empty when the hooks are compiled out
+InstrumentSnapshot GetInstrumentSnapshot();
+
+// One comma-separated line per site: name, calls, iteration limit hits, then the iteration histogram; plus a header
+void WriteInstrumentCsv(const InstrumentSnapshot& snapshot, FILE* file);
+
+// Slot of a site, registering it on the first call for a name. Beyond INSTRUMENT_MAX_SITES, all new sites share a
+// last slot named "(other)". param_b < 0 leaves out the second template parameter.
+int RegisterInstrumentSite(const char* function, int param_a, int param_b);
+
+void InstrumentCall(int site);
+void InstrumentIterations(int site, int num_iterations, bool hit_limit);
+
+#ifdef FIXED_POINT_MATH_INSTRUMENT
+
+#ifdef FIXED_POINT_MATH_HEADER_ONLY
+#error "FIXED_POINT_MATH_INSTRUMENT needs the Fixed_Point_Math library"
+#endif
+
+#define FIXED_POINT_MATH_INSTRUMENT_CALL(function, param_a, param_b)                                \
+    do {                                                                                            \
+        static const int instrument_site = RegisterInstrumentSite(function, param_a, param_b);      \
+        InstrumentCall(instrument_site);                                                            \
+    } while (0)
+
+#define FIXED_POINT_MATH_INSTRUMENT_ITERATIONS(function, param_a, param_b, num_iterations, hit_limit) \
+    do {                                                                                            \
+        static const int instrument_site = RegisterInstrumentSite(function, param_a, param_b);      \
+        InstrumentIterations(instrument_site, num_iterations, hit_limit);                           \
+    } while (0)
+
+#else
+
+#define FIXED_POINT_MATH_INSTRUMENT_CALL(function, param_a, param_b) do {} while (0)
+#define FIXED_POINT_MATH_INSTRUMENT_ITERATIONS(function, param_a, param_b, num_iterations, hit_limit) do {} while (0)
+
+#endif
+
+#endif
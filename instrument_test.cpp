@@ -0,0 +1,131 @@
+// Tests of the instrumentation hooks. This file is only built into `instrument_tests`, where FIXED_POINT_MATH_INSTRUMENT
+// is defined for every source file, so that the scalar functions have the same definition everywhere.
+#ifndef FIXED_POINT_MATH_INSTRUMENT
+#error "instrument_test.cpp needs FIXED_POINT_MATH_INSTRUMENT"
+#endif
+
+#include "instrument.hpp"
+
+#include <doctest.h>
+
+#include <atomic>
+#include <string.h>
+#include <thread>
+
+#include "asin_acos.hpp"
+#include "sin_cos.hpp"
+#include "sqrt.hpp"
+#include "tan.hpp"
+
+static const InstrumentSite* FindSite(const InstrumentSnapshot& snapshot, const char* name) {
+    for (auto const& site : snapshot.sites) {
+        if (strcmp(site.name, name) == 0) {
+            return &site;
+        }
+    }
+
+    return nullptr;
+}
+
+TEST_CASE("Instrument: Sqrtu iterations") {
+    // Sqrtu<5, 3> runs out of steps for the larger numbers: those are the ones that would go on for longer
+    uint32_t numbers[] = {0, 1, 100, 5000, 1'000'000, 4'000'000'000u};
+    int expected_iterations[6];
+    int expected_hits = 0;
+
+    for (int i = 0; i < 6; i++) {
+        int unlimited_iterations;
+        Sqrtu<5, 3>(numbers[i], &expected_iterations[i]);
+        Sqrtu<5, 16>(numbers[i], &unlimited_iterations);
+        expected_hits += unlimited_iterations > 3;
+    }
+
+    auto before = GetInstrumentSnapshot();
+    const InstrumentSite* site_before = FindSite(before, "Sqrtu<5, 3>");
+    REQUIRE(site_before != nullptr);
+
+    for (int i = 0; i < 6; i++) {
+        Sqrtu<5, 3>(numbers[i]);
+    }
+
+    auto after = GetInstrumentSnapshot();
+    const InstrumentSite* site = FindSite(after, "Sqrtu<5, 3>");
+    REQUIRE(site != nullptr);
+
+    // the overload without num_iterations_out counts into the same site
+    CHECK_EQ(site->calls - site_before->calls, 6);
+
+    uint64_t histogram[INSTRUMENT_ITERATION_BUCKETS] = {};
+
+    for (int i = 0; i < 6; i++) {
+        histogram[expected_iterations[i]]++;
+    }
+
+    for (int bucket = 0; bucket < INSTRUMENT_ITERATION_BUCKETS; bucket++) {
+        INFO("bucket = " << bucket);
+        CHECK_EQ(site->iterations[bucket] - site_before->iterations[bucket], histogram[bucket]);
+    }
+
+    CHECK_GE(expected_hits, 1);
+    CHECK_EQ(site->iteration_limit_hits - site_before->iteration_limit_hits, expected_hits);
+}
+
+TEST_CASE("Instrument: call counts over threads") {
+    constexpr int num_threads = 4;
+    constexpr int calls_per_thread = 10000;
+
+    auto count = [](const char* name) {
+        auto snapshot = GetInstrumentSnapshot();
+        const InstrumentSite* site = FindSite(snapshot, name);
+        return site ? site->calls : 0;
+    };
+
+    uint64_t sin_before = count("Sin<17>");
+    uint64_t tan_before = count("Tan<17, 2>");
+    uint64_t asin_before = count("Asin<17, 13>");
+
+    std::vector<std::thread> threads;
+    std::atomic<int64_t> sum{0};
+
+    for (int t = 0; t < num_threads; t++) {
+        threads.emplace_back([&sum, t] {
+            int64_t local = 0;
+
+            for (int i = 0; i < calls_per_thread; i++) {
+                local += Sin<17, int32_t>(i * 13 + t);
+                local += Cos<17, int32_t>(i * 13 + t);
+                local += Tan<17, int32_t, 2>(i * 7);
+                local += Asin<17, int32_t, 13>(i % 8192);
+            }
+
+            sum += local;
+        });
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // the threads have exited, so these all come from the totals they handed in; Cos counts as Sin
+    CHECK_EQ(count("Sin<17>") - sin_before, 2 * num_threads * calls_per_thread);
+    CHECK_EQ(count("Tan<17, 2>") - tan_before, num_threads * calls_per_thread);
+    CHECK_EQ(count("Asin<17, 13>") - asin_before, num_threads * calls_per_thread);
+}
+
+TEST_CASE("Instrument: CSV") {
+    SinFine<19, 1, int32_t>(12345);
+
+    auto snapshot = GetInstrumentSnapshot();
+    FILE* file = tmpfile();
+    REQUIRE(file != nullptr);
+
+    WriteInstrumentCsv(snapshot, file);
+    rewind(file);
+
+    char buffer[16384] = {};
+    fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+
+    CHECK_EQ(strncmp(buffer, "site,calls,iteration_limit_hits,iterations_0,", 45), 0);
+    CHECK(strstr(buffer, "\n\"SinFine<19, 1>\",") != nullptr);
+}
@@ -1,107 +1,105 @@
+// compiles the definitions in log2.hpp into the library
+#define FIXED_POINT_MATH_LOG2_DEFINITIONS
+
+#include "dispatch.hpp"
 #include "log2.hpp"
+#include "verify.hpp"
 
 #include <doctest.h>
 #include <math.h>
+#include <string.h>
 
-static const int8_t LogTable256[256] = {
-#define LT(n) n, n, n, n, n, n, n, n, n, n, n, n, n, n, n, n
-        -1, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
-        LT(4), LT(5), LT(5), LT(6), LT(6), LT(6), LT(6),
-        LT(7), LT(7), LT(7), LT(7), LT(7), LT(7), LT(7), LT(7)
-};
-
-// Source: https://graphics.stanford.edu/~seander/bithacks.html#IntegerLogLookup
-int Log2floor(uint32_t v) {
-    unsigned r;         // r will be lg(v)
-    unsigned int t, tt; // temporaries
+// floor(log2(v)) read off the exponent of (double) v, which is exact for every uint32_t
+static void Log2floorReference(const uint32_t* values, int32_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        double value = values[i];
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
 
-    if (tt = v >> 16) {
-        r = (t = tt >> 8) ? 24 + LogTable256[t] : 16 + LogTable256[tt];
-    }
-    else {
-        r = (t = v >> 8) ? 8 + LogTable256[t] : LogTable256[v];
+        out[i] = values[i] ? (int32_t) (bits >> 52) - 1023 : -1;
     }
+}
 
-    return r;
+static void Log2ceilReference(const uint32_t* values, int32_t* out, size_t count) {
+    Log2floorReference(values, out, count);
+
+    for (size_t i = 0; i < count; i++) {
+        if ((values[i] & (values[i] - 1)) != 0) {
+            out[i]++;
+        }
+    }
 }
 
-int Log2ceil(uint32_t v) {
-    if (v == 0) {
-        return -1;
+static void Log2floorLoop(const uint32_t* values, int32_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = Log2floor(values[i]);
     }
-    else {
-        return Log2floor(v - 1) + 1;
+}
+
+static void Log2ceilLoop(const uint32_t* values, int32_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = Log2ceil(values[i]);
     }
 }
 
-TEST_CASE("Log2floor") {
-    CHECK_EQ(Log2floor(0), -1);
+// The function itself, through `loop`, and every batch kernel the CPU can run, against the reference, over all of
+// 0..2^32-1
+static void CheckExhaustive(VerifyKernel<int32_t> loop, VerifyKernel<int32_t> BatchKernels::*batch_kernel,
+                            VerifyKernel<int32_t> reference) {
+    std::vector<VerifyKernel<int32_t>> candidates = {loop};
+    std::vector<const char*> names = {"function"};
+
+    for (int isa = 0; isa < NUM_ISAS; isa++) {
+        if (auto kernels = GetBatchKernels((Isa) isa)) {
+            candidates.push_back(kernels->*batch_kernel);
+            names.push_back(IsaName((Isa) isa));
+        }
+    }
+
+    auto results = VerifyRange(candidates, reference, 0, UINT64_C(1) << 32);
 
-    // Test 1..2^30-1
-    #pragma omp parallel for default(none)
-    for (int i = 0; i < 0x40; i++) {
-        for (uint32_t j = 0; j <= 0x100'0000; j++) {
-            auto val = (uint32_t) (i << 24 | j);
+    for (size_t i = 0; i < results.size(); i++) {
+        INFO("isa = " << names[i]);
 
-            if (val == 0) {
-                continue;
-            }
+        const auto& mismatches = results[i].mismatches;
 
-            CHECK_EQ(Log2floor(val), (int) floor(log2(val)));
+        for (size_t j = 0; j < mismatches.size(); j++) {
+            INFO("v = " << mismatches[j].input);
+            CHECK_EQ(mismatches[j].got, mismatches[j].expected);
         }
-    }
 
-    // Test 2^30..2^30 + delta
-    for (uint64_t i = 0x4000'0000; i < 0x4111'1111; i++) {
-        auto val = (uint32_t) i;
-        CHECK_EQ(Log2floor(val), (int) floor(log2(val)));
+        CHECK_EQ(results[i].num_checked, UINT64_C(1) << 32);
+        CHECK_EQ(results[i].num_mismatches, 0);
     }
+}
 
-    // Test 2^31 - delta..2^31 + delta
-    for (uint64_t i = 0x7eee'eeee; i < 0x8111'1111; i++) {
-        auto val = (uint32_t) i;
-        CHECK_EQ(Log2floor(val), (int) floor(log2(val)));
-    }
+TEST_CASE("Log2floor") {
+    CHECK_EQ(Log2floor(0), -1);
+
+    // the reference itself, at the edges of every octave
+    for (int i = 0; i < 32; i++) {
+        uint32_t values[] = {UINT32_C(1) << i, (UINT32_C(2) << i) - 1};
+        int32_t out[2];
+        Log2floorReference(values, out, 2);
 
-    // Test 2^32 - delta..2^32 -1
-    for (uint64_t i = 0x8eee'eeee; i <= 0xffff'ffff; i++) {
-        auto val = (uint32_t) i;
-        CHECK_EQ(Log2floor(val), (int) floor(log2(val)));
+        CHECK_EQ(out[0], (int) floor(log2(values[0])));
+        CHECK_EQ(out[1], (int) floor(log2(values[1])));
     }
+
+    CheckExhaustive(Log2floorLoop, &BatchKernels::log2floor, Log2floorReference);
 }
 
 TEST_CASE("Log2ceil") {
     CHECK_EQ(Log2ceil(0), -1);
 
-    // Test 1..2^30-1
-    #pragma omp parallel for default(none)
-    for (int i = 0; i < 0x40; i++) {
-        for (uint32_t j = 0; j <= 0x100'0000; j++) {
-            auto val = (uint32_t) (i << 24 | j);
+    for (int i = 0; i < 32; i++) {
+        uint32_t values[] = {UINT32_C(1) << i, (UINT32_C(1) << i) + 1};
+        int32_t out[2];
+        Log2ceilReference(values, out, 2);
 
-            if (val == 0) {
-                continue;
-            }
-
-            CHECK_EQ(Log2ceil(val), (int) ceil(log2(val)));
-        }
-    }
-
-    // Test 2^30..2^30 + delta
-    for (uint64_t i = 0x4000'0000; i < 0x4111'1111; i++) {
-        auto val = (uint32_t) i;
-        CHECK_EQ(Log2ceil(val), (int) ceil(log2(val)));
+        CHECK_EQ(out[0], (int) ceil(log2(values[0])));
+        CHECK_EQ(out[1], (int) ceil(log2(values[1])));
     }
 
-    // Test 2^31 - delta..2^31 + delta
-    for (uint64_t i = 0x7eee'eeee; i < 0x8111'1111; i++) {
-        auto val = (uint32_t) i;
-        CHECK_EQ(Log2ceil(val), (int) ceil(log2(val)));
-    }
-
-    // Test 2^32 - delta..2^32 -1
-    for (uint64_t i = 0xeeee'eeee; i <= 0xffff'ffff; i++) {
-        auto val = (uint32_t) i;
-        CHECK_EQ(Log2ceil(val), (int) ceil(log2(val)));
-    }
+    CheckExhaustive(Log2ceilLoop, &BatchKernels::log2ceil, Log2ceilReference);
 }
@@ -3,7 +3,55 @@
 
 #include <stdint.h>
 
+inline constexpr int8_t LogTable256[256] = {
+#define LT(n) n, n, n, n, n, n, n, n, n, n, n, n, n, n, n, n
+        -1, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
+        LT(4), LT(5), LT(5), LT(6), LT(6), LT(6), LT(6),
+        LT(7), LT(7), LT(7), LT(7), LT(7), LT(7), LT(7), LT(7)
+#undef LT
+};
+
+// Log2floor and Log2ceil are compiled into the library by log2.cpp. With FIXED_POINT_MATH_HEADER_ONLY they are
+// inline instead, so that callers like Sqrtu can be optimized across the call.
+#if defined(FIXED_POINT_MATH_HEADER_ONLY)
+#define FIXED_POINT_MATH_LOG2_INLINE inline
+#elif defined(FIXED_POINT_MATH_LOG2_DEFINITIONS)
+#define FIXED_POINT_MATH_LOG2_INLINE
+#endif
+
+#ifdef FIXED_POINT_MATH_LOG2_INLINE
+
+// Source: https://graphics.stanford.edu/~seander/bithacks.html#IntegerLogLookup
+FIXED_POINT_MATH_LOG2_INLINE int Log2floor(uint32_t v) {
+    unsigned r;         // r will be lg(v)
+    unsigned int t, tt; // temporaries
+
+    if (tt = v >> 16) {
+        r = (t = tt >> 8) ? 24 + LogTable256[t] : 16 + LogTable256[tt];
+    }
+    else {
+        r = (t = v >> 8) ? 8 + LogTable256[t] : LogTable256[v];
+    }
+
+    return r;
+}
+
+FIXED_POINT_MATH_LOG2_INLINE int Log2ceil(uint32_t v) {
+    if (v == 0) {
+        return -1;
+    }
+    else {
+        return Log2floor(v - 1) + 1;
+    }
+}
+
+#undef FIXED_POINT_MATH_LOG2_INLINE
+
+#else
+
 int Log2floor(uint32_t v);
 int Log2ceil(uint32_t v);
 
 #endif
+
+#endif
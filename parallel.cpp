@@ -0,0 +1,216 @@
+#include "parallel.hpp"
+#include "sqrt.hpp"
+
+#include <doctest.h>
+
+ThreadPool::ThreadPool(int num_threads) {
+    if (num_threads <= 0) {
+        num_threads = (int) std::thread::hardware_concurrency();
+    }
+
+    for (int i = 1; i < num_threads; i++) {
+        workers.emplace_back([this] { WorkerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+
+    wake.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// The pool whose chunks the current thread is running, if any
+static thread_local const ThreadPool* running_pool = nullptr;
+
+void ThreadPool::Run(size_t num_chunks, void (*call)(void* context, size_t chunk), void* context) {
+    // Nested in a chunk of our own job, which holds run_mutex until this call returns
+    if (running_pool == this) {
+        for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+            call(context, chunk);
+        }
+
+        return;
+    }
+
+    std::lock_guard<std::mutex> run_lock(run_mutex);
+
+    {
+        // A worker that woke up late for the previous job may still be on its way out
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this] { return num_active == 0; });
+
+        job_call = call;
+        job_context = context;
+        job_num_chunks = num_chunks;
+        next_chunk.store(0, std::memory_order_relaxed);
+        generation++;
+    }
+
+    wake.notify_all();
+    RunChunks();
+
+    // All chunks have been claimed, wait until the workers have finished theirs
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return num_active == 0; });
+}
+
+void ThreadPool::RunChunks() {
+    // a chunk may itself run a job on another pool
+    const ThreadPool* outer_pool = running_pool;
+    running_pool = this;
+
+    size_t chunk;
+
+    while ((chunk = next_chunk.fetch_add(1, std::memory_order_relaxed)) < job_num_chunks) {
+        job_call(job_context, chunk);
+    }
+
+    running_pool = outer_pool;
+}
+
+void ThreadPool::WorkerLoop() {
+    uint64_t seen_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    for (;;) {
+        wake.wait(lock, [&] { return stopping || generation != seen_generation; });
+
+        if (stopping) {
+            return;
+        }
+
+        seen_generation = generation;
+        num_active++;
+
+        lock.unlock();
+        RunChunks();
+        lock.lock();
+
+        if (--num_active == 0) {
+            idle.notify_all();
+        }
+    }
+}
+
+ThreadPool& DefaultThreadPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+TEST_CASE("ThreadPool::ParallelFor") {
+    ThreadPool pool(4);
+    CHECK_EQ(pool.GetNumThreads(), 4);
+
+    // every chunk exactly once, over many consecutive jobs
+    for (size_t num_chunks = 0; num_chunks < 200; num_chunks += 7) {
+        std::vector<std::atomic<int>> calls(num_chunks);
+
+        pool.ParallelFor(num_chunks, [&](size_t chunk) { calls[chunk]++; });
+
+        for (size_t i = 0; i < num_chunks; i++) {
+            CHECK_EQ(calls[i].load(), 1);
+        }
+    }
+
+    // jobs submitted from several threads at once
+    std::atomic<int> total{0};
+    std::vector<std::thread> submitters;
+
+    for (int i = 0; i < 4; i++) {
+        submitters.emplace_back([&] {
+            for (int j = 0; j < 50; j++) {
+                pool.ParallelFor(10, [&](size_t) { total++; });
+            }
+        });
+    }
+
+    for (auto& submitter : submitters) {
+        submitter.join();
+    }
+
+    CHECK_EQ(total.load(), 4 * 50 * 10);
+
+    // nested on the same pool, from the calling thread and from the workers alike, and on another pool
+    ThreadPool other_pool(2);
+    std::vector<std::atomic<int>> nested_calls(16 * 16);
+
+    pool.ParallelFor(16, [&](size_t outer) {
+        pool.ParallelFor(8, [&](size_t inner) { nested_calls[outer * 16 + inner]++; });
+        other_pool.ParallelFor(8, [&](size_t inner) { nested_calls[outer * 16 + 8 + inner]++; });
+    });
+
+    for (auto& calls : nested_calls) {
+        CHECK_EQ(calls.load(), 1);
+    }
+}
+
+TEST_CASE("ParallelForAligned") {
+    ThreadPool pool(3);
+    alignas(64) int32_t out[1000];
+
+    for (size_t offset = 0; offset < 16; offset++) {
+        std::vector<std::atomic<int>> covered(1000 - offset);
+        std::atomic<bool> misaligned{false};
+
+        ParallelForAligned(out + offset, covered.size(), {&pool, 100}, [&](size_t begin, size_t end) {
+            // rounded up to 112 elements = 7 cache lines
+            if (begin != 0 && (uintptr_t) (out + offset + begin) % CACHE_LINE_SIZE != 0) {
+                misaligned = true;
+            }
+
+            if (end - begin > 112) {
+                misaligned = true;
+            }
+
+            for (size_t i = begin; i < end; i++) {
+                covered[i]++;
+            }
+        });
+
+        CHECK_FALSE(misaligned.load());
+
+        for (auto& count : covered) {
+            CHECK_EQ(count.load(), 1);
+        }
+    }
+}
+
+TEST_CASE("Parallel batch entry points") {
+    ThreadPool pool(4);
+    ParallelConfig config = {&pool, 1000};
+
+    std::vector<uint32_t> inputs(100'003);
+    uint32_t state = 1;
+
+    for (auto& input : inputs) {
+        state = state * 1664525 + 1013904223;
+        input = state >> (state % 29);
+    }
+
+    std::vector<int32_t> angles(inputs.begin(), inputs.end());
+    std::vector<uint32_t> roots(inputs.size());
+    std::vector<int32_t> out(inputs.size());
+
+    SqrtuBatchParallel(inputs.data(), roots.data(), inputs.size(), config);
+    for (size_t i = 0; i < inputs.size(); i++) { REQUIRE_EQ(roots[i], Sqrtu(inputs[i])); }
+
+    Log2floorBatchParallel(inputs.data(), out.data(), inputs.size(), config);
+    for (size_t i = 0; i < inputs.size(); i++) { REQUIRE_EQ(out[i], Log2floor(inputs[i])); }
+
+    Log2ceilBatchParallel(inputs.data(), out.data(), inputs.size(), config);
+    for (size_t i = 0; i < inputs.size(); i++) { REQUIRE_EQ(out[i], Log2ceil(inputs[i])); }
+
+    SinBatchParallel<16>(angles.data() + 1, out.data() + 1, angles.size() - 1, config);
+    for (size_t i = 1; i < inputs.size(); i++) { REQUIRE_EQ(out[i], (Sin<16, int32_t>(angles[i]))); }
+
+    // default pool and chunk size
+    CosBatchParallel<16>(angles.data(), out.data(), angles.size());
+    for (size_t i = 0; i < inputs.size(); i++) { REQUIRE_EQ(out[i], (Cos<16, int32_t>(angles[i]))); }
+}
@@ -0,0 +1,145 @@
+#ifndef FIXED_POINT_MATH_PARALLEL_HPP
+#define FIXED_POINT_MATH_PARALLEL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "batch.hpp"
+
+// Multithreaded versions of the batch entry points, for arrays much larger than the caches.
+// The work is split into chunks which are handed out to a persistent pool of threads; the calling thread takes part
+// too. Chunk boundaries fall on cache lines of the output array, so that no two threads ever write the same line.
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+class ThreadPool {
+public:
+    // num_threads counts the calling thread as well; 0 means one per hardware thread
+    explicit ThreadPool(int num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int GetNumThreads() const { return (int) workers.size() + 1; }
+
+    // Calls func(i) for every i in [0, num_chunks), in no particular order, and returns when all calls have
+    // returned. Calls from several threads at once are serialized. A call from inside func, on the same pool, runs
+    // all of its chunks on the calling thread, since the pool is busy with the outer job.
+    template <typename Func>
+    void ParallelFor(size_t num_chunks, Func&& func) {
+        using Func_t = std::remove_reference_t<Func>;
+        Run(num_chunks, [](void* context, size_t chunk) { (*(Func_t*) context)(chunk); }, (void*) &func);
+    }
+
+private:
+    void Run(size_t num_chunks, void (*call)(void* context, size_t chunk), void* context);
+    void RunChunks();
+    void WorkerLoop();
+
+    std::vector<std::thread> workers;
+
+    std::mutex run_mutex;           // one job at a time
+    std::mutex mutex;               // protects everything below, except next_chunk
+    std::condition_variable wake;
+    std::condition_variable idle;
+    uint64_t generation = 0;        // incremented for every job
+    int num_active = 0;             // workers currently inside RunChunks
+    bool stopping = false;
+
+    void (*job_call)(void* context, size_t chunk) = nullptr;
+    void* job_context = nullptr;
+    size_t job_num_chunks = 0;
+    std::atomic<size_t> next_chunk{0};
+};
+
+// Shared pool with one thread per hardware thread, created on first use
+ThreadPool& DefaultThreadPool();
+
+struct ParallelConfig {
+    ThreadPool* pool = nullptr;                 // nullptr: DefaultThreadPool()
+    size_t chunk_size = DEFAULT_CHUNK_SIZE;     // elements; rounded up to whole cache lines of output
+};
+
+// Calls func(begin, end) on consecutive ranges covering [0, count). Apart from the first range, which brings `out`
+// up to a cache line boundary, every range starts on a cache line of `out`.
+template <typename Out_t, typename Func>
+void ParallelForAligned(const Out_t* out, size_t count, const ParallelConfig& config, Func func) {
+    constexpr size_t elements_per_line = CACHE_LINE_SIZE / sizeof(Out_t);
+
+    size_t chunk_size = (config.chunk_size + elements_per_line - 1) / elements_per_line * elements_per_line;
+
+    if (chunk_size == 0) {
+        chunk_size = elements_per_line;
+    }
+
+    if (count <= chunk_size) {
+        func((size_t) 0, count);
+        return;
+    }
+
+    size_t misalignment = (uintptr_t) out % CACHE_LINE_SIZE;
+    size_t head = misalignment ? (CACHE_LINE_SIZE - misalignment) / sizeof(Out_t) : 0;
+    size_t num_chunks = (head ? 1 : 0) + (count - head + chunk_size - 1) / chunk_size;
+
+    ThreadPool& pool = config.pool ? *config.pool : DefaultThreadPool();
+
+    pool.ParallelFor(num_chunks, [&](size_t chunk) {
+        if (head) {
+            if (chunk == 0) {
+                func((size_t) 0, head);
+                return;
+            }
+
+            chunk--;
+        }
+
+        size_t begin = head + chunk * chunk_size;
+        size_t end = (count - begin > chunk_size) ? begin + chunk_size : count;
+        func(begin, end);
+    });
+}
+
+template <int TOLERANCE_BITS = 6, int MAX_ITERATIONS = 10>
+void SqrtuBatchParallel(const uint32_t* numbers, uint32_t* out, size_t count, const ParallelConfig& config = {}) {
+    ParallelForAligned(out, count, config, [=](size_t begin, size_t end) {
+        SqrtuBatch<TOLERANCE_BITS, MAX_ITERATIONS>(numbers + begin, out + begin, end - begin);
+    });
+}
+
+inline void Log2floorBatchParallel(const uint32_t* values, int32_t* out, size_t count,
+                                   const ParallelConfig& config = {}) {
+    ParallelForAligned(out, count, config, [=](size_t begin, size_t end) {
+        Log2floorBatch(values + begin, out + begin, end - begin);
+    });
+}
+
+inline void Log2ceilBatchParallel(const uint32_t* values, int32_t* out, size_t count,
+                                  const ParallelConfig& config = {}) {
+    ParallelForAligned(out, count, config, [=](size_t begin, size_t end) {
+        Log2ceilBatch(values + begin, out + begin, end - begin);
+    });
+}
+
+template <int angle_bits>
+void SinBatchParallel(const int32_t* angles, int32_t* out, size_t count, const ParallelConfig& config = {}) {
+    ParallelForAligned(out, count, config, [=](size_t begin, size_t end) {
+        SinBatch<angle_bits>(angles + begin, out + begin, end - begin);
+    });
+}
+
+template <int angle_bits>
+void CosBatchParallel(const int32_t* angles, int32_t* out, size_t count, const ParallelConfig& config = {}) {
+    ParallelForAligned(out, count, config, [=](size_t begin, size_t end) {
+        CosBatch<angle_bits>(angles + begin, out + begin, end - begin);
+    });
+}
+
+#endif
@@ -0,0 +1,125 @@
+#include "policy.hpp"
+
+#include <doctest.h>
+
+#include <math.h>
+
+// Largest |Sin - 4096 sin(x)| and |Cos - 4096 cos(x)|, over every angle or, for wide angles, about 2**20 of them
+template <typename Policy, int angle_bits>
+static double SinMaxError() {
+    constexpr uint64_t num_angles = UINT64_C(1) << angle_bits;
+    constexpr uint64_t stride = angle_bits > 20 ? (UINT64_C(1) << (angle_bits - 20)) - 1 : 1;
+
+    double max_error = 0;
+
+    for (uint64_t angle = 0; angle < num_angles; angle += stride) {
+        double x = 2 * M_PI * (double) angle / (double) num_angles;
+
+        max_error = fmax(max_error, fabs(Sin<Policy, angle_bits, uint32_t>((uint32_t) angle) - sin(x) * 4096));
+        max_error = fmax(max_error, fabs(Cos<Policy, angle_bits, uint32_t>((uint32_t) angle) - cos(x) * 4096));
+    }
+
+    return max_error;
+}
+
+template <typename Policy>
+static void CheckSin() {
+    CHECK_LE(SinMaxError<Policy, 4>(), Policy::sin_max_error);
+    CHECK_LE(SinMaxError<Policy, 8>(), Policy::sin_max_error);
+    CHECK_LE(SinMaxError<Policy, 10>(), Policy::sin_max_error);
+    CHECK_LE(SinMaxError<Policy, 12>(), Policy::sin_max_error);
+    CHECK_LE(SinMaxError<Policy, 16>(), Policy::sin_max_error);
+    CHECK_LE(SinMaxError<Policy, 20>(), Policy::sin_max_error);
+    CHECK_LE(SinMaxError<Policy, 24>(), Policy::sin_max_error);
+    CHECK_LE(SinMaxError<Policy, 32>(), Policy::sin_max_error);
+}
+
+// Every number up to 2**20, then about 2**20 more spread over the rest of the range
+template <typename Policy>
+static void CheckSqrtu() {
+    for (uint64_t number = 0; number <= UINT32_MAX; number += (number < (1 << 20)) ? 1 : 4093) {
+        double exact = sqrt((double) number);
+
+        INFO("number = " << number);
+        REQUIRE_LE(fabs(Sqrtu<Policy>((uint32_t) number) - exact), Policy::sqrt_max_relative_error * exact + 1);
+    }
+}
+
+template <typename Policy, int angle_bits>
+static void CheckTan() {
+    constexpr int64_t num_angles = INT64_C(1) << angle_bits;
+
+    for (int64_t angle = 0; angle < num_angles; angle++) {
+        int32_t result = Tan<Policy, angle_bits, int32_t>((int32_t) angle);
+
+        if ((angle & (num_angles / 2 - 1)) == num_angles / 4) {
+            REQUIRE_EQ(result, INT32_MAX);
+            continue;
+        }
+
+        double exact = tan(2 * M_PI * (double) angle / (double) num_angles) * 4096;
+        exact = fmax(fmin(exact, INT32_MAX), -INT32_MAX);
+
+        INFO("angle = " << angle);
+        REQUIRE_LE(fabs(result - exact), fmax(1.0, fabs(exact) * Policy::tan_max_relative_error));
+    }
+}
+
+template <typename Policy, int angle_bits>
+static void CheckAsinAcos() {
+    constexpr int32_t one = 4096;
+
+    for (int32_t ratio = -one; ratio <= one; ratio++) {
+        double exact = asin((double) ratio / one) / (2 * M_PI) * pow(2, angle_bits);
+
+        REQUIRE_LE(fabs(Asin<Policy, angle_bits, int32_t>(ratio) - exact), Policy::asin_max_error);
+        REQUIRE_LE(fabs(Acos<Policy, angle_bits, int32_t>(ratio) - (pow(2, angle_bits - 2) - exact)),
+                   Policy::asin_max_error);
+    }
+}
+
+template <typename Policy>
+static void CheckPolicy() {
+    CheckSin<Policy>();
+    CheckSqrtu<Policy>();
+    CheckTan<Policy, 12>();
+    CheckTan<Policy, 16>();
+    CheckAsinAcos<Policy, 12>();
+    CheckAsinAcos<Policy, 16>();
+}
+
+TEST_CASE("Policy Fast") {
+    CheckPolicy<Fast>();
+}
+
+TEST_CASE("Policy Balanced") {
+    CheckPolicy<Balanced>();
+
+    // the same as the plain functions
+    for (int32_t angle = 0; angle < 65536; angle++) {
+        REQUIRE_EQ(Sin<Balanced, 16, int32_t>(angle), Sin<16, int32_t>(angle));
+        REQUIRE_EQ(Tan<Balanced, 16, int32_t>(angle), Tan<16, int32_t>(angle));
+    }
+
+    for (uint32_t number = 0; number < (1 << 20); number++) {
+        REQUIRE_EQ(Sqrtu<Balanced>(number), Sqrtu(number));
+    }
+}
+
+TEST_CASE("Policy Exact") {
+    CheckPolicy<Exact>();
+
+    // exactly floor(sqrt(n)), checked around every perfect square
+    for (uint64_t root = 0; root < 65536; root++) {
+        uint32_t square = (uint32_t) (root * root);
+
+        REQUIRE_EQ(Sqrtu<Exact>(square), root);
+        REQUIRE_EQ(Sqrtu<Exact>((uint32_t) (root * root + 2 * root)), root);
+
+        if (root > 0) {
+            REQUIRE_EQ(Sqrtu<Exact>(square - 1), root - 1);
+        }
+    }
+
+    CHECK_EQ(Sqrtu<Exact>(UINT32_MAX), 65535);
+}
@@ -0,0 +1,131 @@
+#ifndef FIXED_POINT_MATH_POLICY_HPP
+#define FIXED_POINT_MATH_POLICY_HPP
+
+#include <stdint.h>
+
+#include "asin_acos.hpp"
+#include "sin_cos.hpp"
+#include "sqrt.hpp"
+#include "tan.hpp"
+
+// Named accuracy/speed presets. The functions below take a preset as their first template argument in place of the
+// individual tuning parameters, e.g. Sin<Fast, 16>(angle) or Sqrtu<Exact>(number), and otherwise behave like the
+// plain versions.
+//
+// Every preset states its error bounds, and policy.cpp checks them for every preset:
+//  - sin_max_error: |Sin - 4096 sin(x)|, the same for Cos, for any angle_bits
+//  - sqrt_max_relative_error: |Sqrtu(n) - sqrt(n)| <= sqrt_max_relative_error * sqrt(n) + 1
+//  - tan_max_relative_error: |Tan - 4096 tan(x)| <= max(1, tan_max_relative_error * 4096 |tan(x)|),
+//    wherever 4096 tan(x) fits in 32 bits
+//  - asin_max_error: |Asin - exact| and |Acos - exact| in units of the output angle, for angle_bits up to 16
+//
+// Log2floor and Log2ceil are exact and cheap, so they take no preset. Asin and Acos have a single implementation,
+// which all presets share.
+
+// Which table Sin interpolates: sin_table (SIN_TABLE_BITS, Q12) or sin_fine_table (SIN_FINE_TABLE_BITS, Q20). Named
+// rather than told apart by size, since SIN_TABLE_BITS can be configured to the same size as the fine table.
+enum class SinTableKind {
+    coarse,
+    fine,
+};
+
+constexpr int SinTableBits(SinTableKind table) {
+    return table == SinTableKind::coarse ? SIN_TABLE_BITS : SIN_FINE_TABLE_BITS;
+}
+
+// Table lookups without interpolation and short iterations
+struct Fast {
+    static constexpr SinTableKind sin_table_kind = SinTableKind::fine;
+    static constexpr int sin_interpolation_order = 0;
+    static constexpr double sin_max_error = 13.2;
+
+    static constexpr int sqrt_tolerance_bits = 3;
+    static constexpr int sqrt_max_iterations = 3;
+    static constexpr double sqrt_max_relative_error = 1.0 / 16;
+
+    static constexpr int tan_newton_steps = 0;
+    static constexpr double tan_max_relative_error = 1.0 / 64;
+
+    static constexpr double asin_max_error = 1.25;
+};
+
+// The defaults of the plain functions
+struct Balanced {
+    static constexpr SinTableKind sin_table_kind = SinTableKind::coarse;
+    static constexpr int sin_interpolation_order = 1;
+    static constexpr double sin_max_error = (SIN_TABLE_BITS >= 6) ? 1.2 : 2.0;       // see sin_cos.hpp
+
+    static constexpr int sqrt_tolerance_bits = 6;
+    static constexpr int sqrt_max_iterations = 10;
+    static constexpr double sqrt_max_relative_error = 1.0 / 128;
+
+    static constexpr int tan_newton_steps = 1;
+    static constexpr double tan_max_relative_error = 1.0 / 4096;
+
+    static constexpr double asin_max_error = 1.25;
+};
+
+// As close to correctly rounded as the output format allows; Sqrtu is exactly floor(sqrt(n))
+struct Exact {
+    static constexpr SinTableKind sin_table_kind = SinTableKind::fine;
+    static constexpr int sin_interpolation_order = 1;
+    static constexpr double sin_max_error = 0.52;
+
+    static constexpr int sqrt_tolerance_bits = 16;
+    static constexpr int sqrt_max_iterations = 16;
+    static constexpr double sqrt_max_relative_error = 0;
+
+    static constexpr int tan_newton_steps = 2;
+    static constexpr double tan_max_relative_error = 1.0 / 4096;
+
+    static constexpr double asin_max_error = 1.25;
+};
+
+template <typename Policy, int angle_bits, typename Angle_t>
+int32_t Sin(Angle_t angle) {
+    static_assert(Policy::sin_table_kind == SinTableKind::fine || Policy::sin_interpolation_order == 1,
+                  "sin_table is only interpolated linearly");
+
+    // nothing to interpolate at these resolutions, every preset gets the correctly rounded table entry
+    if constexpr (angle_bits <= SIN_DIRECT_MAX_ANGLE_BITS) {
+        return Sin<angle_bits, Angle_t>(angle);
+    }
+    else if constexpr (angle_bits <= SinTableBits(Policy::sin_table_kind) + 2) {
+        return SinDirect<angle_bits, Angle_t>(angle);
+    }
+    else if constexpr (Policy::sin_table_kind == SinTableKind::coarse) {
+        return Sin<angle_bits, Angle_t>(angle);
+    }
+    else {
+        return SinFine<angle_bits, Policy::sin_interpolation_order, Angle_t>(angle);
+    }
+}
+
+template <typename Policy, int angle_bits, typename Angle_t>
+int32_t Cos(Angle_t angle) {
+    constexpr uint32_t half_pi_radians = UINT32_C(1) << (angle_bits - 2);
+
+    return Sin<Policy, angle_bits, uint32_t>((uint32_t) angle + half_pi_radians);
+}
+
+template <typename Policy>
+uint32_t Sqrtu(uint32_t number) {
+    return Sqrtu<Policy::sqrt_tolerance_bits, Policy::sqrt_max_iterations>(number);
+}
+
+template <typename Policy, int angle_bits, typename Angle_t>
+int32_t Tan(Angle_t angle) {
+    return Tan<angle_bits, Angle_t, Policy::tan_newton_steps>(angle);
+}
+
+template <typename Policy, int angle_bits, typename Ratio_t, int frac_bits = 12>
+int32_t Asin(Ratio_t ratio) {
+    return Asin<angle_bits, Ratio_t, frac_bits>(ratio);
+}
+
+template <typename Policy, int angle_bits, typename Ratio_t, int frac_bits = 12>
+int32_t Acos(Ratio_t ratio) {
+    return Acos<angle_bits, Ratio_t, frac_bits>(ratio);
+}
+
+#endif
@@ -0,0 +1,69 @@
+#include "rotate.hpp"
+
+#include <doctest.h>
+
+#include <vector>
+
+TEST_CASE("RotateX, RotateY") {
+    // a quarter turn is exact
+    CHECK_EQ(RotateX(1000, 7, 0, 4096), -7);
+    CHECK_EQ(RotateY(1000, 7, 0, 4096), 1000);
+
+    // rounded once, half up
+    CHECK_EQ(RotateX(1, 0, 2048, 0), 1);
+    CHECK_EQ(RotateX(-1, 0, 2048, 0), 0);
+    CHECK_EQ(RotateX(3, 1, 2048, 2048), 1);
+
+    CHECK_EQ(RotateX(1 << 30, -(1 << 30), 4096, 0), 1 << 30);
+    CHECK_EQ(RotateY(1 << 30, -(1 << 30), 4096, 0), -(1 << 30));
+}
+
+TEST_CASE("Rotate2D, Rotate2DPerPoint") {
+    std::vector<int32_t> xs, ys, angles;
+    uint32_t state = 1;
+
+    for (int i = 0; i < 1001; i++) {
+        state = state * 1664525 + 1013904223;
+        xs.push_back((int32_t) state >> (2 + state % 20));
+        state = state * 1664525 + 1013904223;
+        ys.push_back((int32_t) state >> (2 + state % 20));
+        angles.push_back((int32_t) state);
+    }
+
+    std::vector<int32_t> out_x(xs.size()), out_y(xs.size());
+
+    Rotate2D<12>(xs.data(), ys.data(), out_x.data(), out_y.data(), xs.size(), 345);
+
+    for (size_t i = 0; i < xs.size(); i++) {
+        REQUIRE_EQ(out_x[i], RotateX(xs[i], ys[i], Cos<12, int32_t>(345), Sin<12, int32_t>(345)));
+        REQUIRE_EQ(out_y[i], RotateY(xs[i], ys[i], Cos<12, int32_t>(345), Sin<12, int32_t>(345)));
+    }
+
+    // narrow angle types, and in place
+    auto in_x = xs;
+    auto in_y = ys;
+    Rotate2D<16>(in_x.data(), in_y.data(), in_x.data(), in_y.data(), in_x.size(), (int16_t) -12345);
+
+    for (size_t i = 0; i < xs.size(); i++) {
+        REQUIRE_EQ(in_x[i], RotateX(xs[i], ys[i], Cos<16, int16_t>(-12345), Sin<16, int16_t>(-12345)));
+        REQUIRE_EQ(in_y[i], RotateY(xs[i], ys[i], Cos<16, int16_t>(-12345), Sin<16, int16_t>(-12345)));
+    }
+
+    Rotate2DPerPoint<16>(xs.data(), ys.data(), angles.data(), out_x.data(), out_y.data(), xs.size());
+
+    for (size_t i = 0; i < xs.size(); i++) {
+        int32_t cos = Cos<16, int32_t>(angles[i]);
+        int32_t sin = Sin<16, int32_t>(angles[i]);
+
+        REQUIRE_EQ(out_x[i], RotateX(xs[i], ys[i], cos, sin));
+        REQUIRE_EQ(out_y[i], RotateY(xs[i], ys[i], cos, sin));
+    }
+
+    // half a turn negates exactly
+    Rotate2D<12>(xs.data(), ys.data(), out_x.data(), out_y.data(), xs.size(), 2048);
+
+    for (size_t i = 0; i < xs.size(); i++) {
+        REQUIRE_EQ(out_x[i], -xs[i]);
+        REQUIRE_EQ(out_y[i], -ys[i]);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef FIXED_POINT_MATH_ROTATE_HPP
+#define FIXED_POINT_MATH_ROTATE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arith.hpp"
+#include "batch.hpp"
+#include "dispatch.hpp"
+#include "sin_cos.hpp"
+
+// Rotation of 2D points by a binary angle, over structure-of-arrays buffers.
+//
+// cos and sin come from Cos/Sin and have 12 fractional bits; every output coordinate is rounded once, from the
+// exact 64-bit sum of products. Results are computed modulo 2**32, so it is up to the caller to keep coordinates
+// small enough not to overflow (anything within +/-2**30 is safe). Input and output arrays may be the same.
+
+// x cos - y sin
+inline int32_t RotateX(int32_t x, int32_t y, int32_t cos, int32_t sin) {
+    return (int32_t) ShiftRound<12>((int64_t) x * cos - (int64_t) y * sin);
+}
+
+// x sin + y cos
+inline int32_t RotateY(int32_t x, int32_t y, int32_t cos, int32_t sin) {
+    return (int32_t) ShiftRound<12>((int64_t) x * sin + (int64_t) y * cos);
+}
+
+// All points by the same angle; sin and cos are computed once
+template <int angle_bits, typename Angle_t>
+void Rotate2D(const int32_t* xs, const int32_t* ys, int32_t* out_x, int32_t* out_y, size_t n, Angle_t angle) {
+    int32_t cos = Cos<angle_bits, Angle_t>(angle);
+    int32_t sin = Sin<angle_bits, Angle_t>(angle);
+
+    GetBatchKernels().rotate2d(xs, ys, out_x, out_y, n, cos, sin);
+}
+
+// Every point by its own angle
+template <int angle_bits>
+void Rotate2DPerPoint(const int32_t* xs, const int32_t* ys, const int32_t* angles, int32_t* out_x, int32_t* out_y,
+                      size_t n) {
+    static_assert(angle_bits >= SIN_TABLE_BITS + 2 && angle_bits <= MAX_BATCH_ANGLE_BITS, "angle_bits out of range");
+
+    GetBatchKernels().rotate2d_per_point(xs, ys, angles, out_x, out_y, n, angle_bits);
+}
+
+#endif
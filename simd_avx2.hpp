@@ -0,0 +1,98 @@
+#ifndef FIXED_POINT_MATH_SIMD_AVX2_HPP
+#define FIXED_POINT_MATH_SIMD_AVX2_HPP
+
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// AVX2 backend for batch_kernels.hpp, 8 lanes. Only include from a file compiled with -mavx2.
+
+struct SimdAvx2 {
+    static constexpr int width = 8;
+
+    using Vec = __m256i;
+    using Mask = __m256i;
+
+    struct PairTable {
+        const uint16_t* table;
+
+        PairTable(const uint16_t* table, int /* num_pairs */) : table(table) {}
+    };
+
+    static Vec Load(const void* ptr) { return _mm256_loadu_si256((const __m256i*) ptr); }
+    static void Store(void* ptr, Vec v) { _mm256_storeu_si256((__m256i*) ptr, v); }
+
+    static Vec LoadPartial(const void* ptr, size_t count) {
+        uint32_t lanes[width] = {};
+        memcpy(lanes, ptr, count * sizeof(uint32_t));
+        return Load(lanes);
+    }
+
+    static void StorePartial(void* ptr, Vec v, size_t count) {
+        uint32_t lanes[width];
+        Store(lanes, v);
+        memcpy(ptr, lanes, count * sizeof(uint32_t));
+    }
+
+    static Vec Set1(uint32_t value) { return _mm256_set1_epi32((int) value); }
+
+    static Vec Add(Vec a, Vec b) { return _mm256_add_epi32(a, b); }
+    static Vec Sub(Vec a, Vec b) { return _mm256_sub_epi32(a, b); }
+    static Vec MulLo(Vec a, Vec b) { return _mm256_mullo_epi32(a, b); }
+    static Vec And(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+    static Vec Xor(Vec a, Vec b) { return _mm256_xor_si256(a, b); }
+    static Vec MaxS(Vec a, Vec b) { return _mm256_max_epi32(a, b); }
+    static Vec ShiftRight(Vec a, int count) { return _mm256_srl_epi32(a, _mm_cvtsi32_si128(count)); }
+    static Vec Pow2(Vec exponent) { return _mm256_sllv_epi32(_mm256_set1_epi32(1), exponent); }
+
+    // Read off the exponent of the lane converted to float. Clearing every bit right below a set one keeps the
+    // highest bit and leaves a zero under it, so values above 2**24 cannot round up to the next power of two. Lanes
+    // with bit 31 set convert to negative floats, whose sign bit takes 158 - exponent below zero.
+    static Vec Clz(Vec v) {
+        __m256i isolated = _mm256_andnot_si256(_mm256_srli_epi32(v, 1), v);
+        __m256i exponent = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(isolated)), 23);
+
+        // 158 - (127 + log2) = 31 - log2, and 158 for zero
+        __m256i count = _mm256_sub_epi32(_mm256_set1_epi32(158), exponent);
+        return _mm256_min_epi32(_mm256_max_epi32(count, _mm256_setzero_si256()), _mm256_set1_epi32(32));
+    }
+
+    static Vec SqrtFloat(Vec a) { return _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(a))); }
+
+    static Vec AddSat16(Vec a, Vec b) { return _mm256_adds_epi16(a, b); }
+    static Vec SubSat16(Vec a, Vec b) { return _mm256_subs_epi16(a, b); }
+    static Vec MulhRound16(Vec a, Vec b) { return _mm256_mulhrs_epi16(a, b); }
+    static Vec CmpEq16(Vec a, Vec b) { return _mm256_cmpeq_epi16(a, b); }
+    static Vec MaddPairs16(Vec a, Vec b) { return _mm256_madd_epi16(a, b); }
+
+    static Vec MulEven32(Vec a, Vec b) { return _mm256_mul_epi32(a, b); }
+    static Vec Add64(Vec a, Vec b) { return _mm256_add_epi64(a, b); }
+    static Vec ShiftRight64(Vec a, int count) { return _mm256_srl_epi64(a, _mm_cvtsi32_si128(count)); }
+    static Vec ShiftLeft64(Vec a, int count) { return _mm256_sll_epi64(a, _mm_cvtsi32_si128(count)); }
+
+    static Mask CmpEq(Vec a, Vec b) { return _mm256_cmpeq_epi32(a, b); }
+
+    static Mask CmpGtU(Vec a, Vec b) {
+        return _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_max_epu32(a, b), b), _mm256_set1_epi32(-1));
+    }
+
+    static Mask Test(Vec a, Vec b) {
+        return _mm256_xor_si256(CmpEq(And(a, b), _mm256_setzero_si256()), _mm256_set1_epi32(-1));
+    }
+
+    static Mask MaskAnd(Mask a, Mask b) { return _mm256_and_si256(a, b); }
+    static Mask MaskAndNot(Mask a, Mask b) { return _mm256_andnot_si256(b, a); }
+    static bool Any(Mask m) { return !_mm256_testz_si256(m, m); }
+
+    static Vec Select(Mask mask, Vec if_true, Vec if_false) { return _mm256_blendv_epi8(if_false, if_true, mask); }
+
+    // a 32-bit gather at a 16-bit stride fetches table[index] and table[index + 1] at once
+    static Vec LookupPairs(const PairTable& t, Vec index) {
+        return _mm256_i32gather_epi32((const int*) t.table, index, 2);
+    }
+
+    static Vec Gather(const void* base, Vec offset) { return _mm256_i32gather_epi32((const int*) base, offset, 1); }
+};
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef FIXED_POINT_MATH_SIMD_AVX512_HPP
+#define FIXED_POINT_MATH_SIMD_AVX512_HPP
+
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// AVX-512 backend for batch_kernels.hpp, 16 lanes. Only include from a file compiled with -mavx512{f,cd,bw,dq,vl}.
+
+struct SimdAvx512 {
+    static constexpr int width = 16;
+
+    using Vec = __m512i;
+    using Mask = __mmask16;
+
+    // Tables of 32 or 64 pairs are kept in two or four registers and looked up with vpermi2d;
+    // larger ones are gathered from memory.
+    struct PairTable {
+        const uint16_t* table;
+        int num_registers;
+        __m512i pairs[4];
+
+        PairTable(const uint16_t* table, int num_pairs) : table(table) {
+            num_registers = (num_pairs == 32 || num_pairs == 64) ? num_pairs / 16 : 0;
+
+            for (int i = 0; i < num_registers; i++) {
+                __m512i low = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*) &table[i * 16]));
+                __m512i high = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*) &table[i * 16 + 1]));
+                pairs[i] = _mm512_or_si512(low, _mm512_slli_epi32(high, 16));
+            }
+        }
+    };
+
+    static Vec Load(const void* ptr) { return _mm512_loadu_si512(ptr); }
+    static void Store(void* ptr, Vec v) { _mm512_storeu_si512(ptr, v); }
+
+    static Vec LoadPartial(const void* ptr, size_t count) {
+        return _mm512_maskz_loadu_epi32((__mmask16) ((1u << count) - 1), ptr);
+    }
+
+    static void StorePartial(void* ptr, Vec v, size_t count) {
+        _mm512_mask_storeu_epi32(ptr, (__mmask16) ((1u << count) - 1), v);
+    }
+
+    static Vec Set1(uint32_t value) { return _mm512_set1_epi32((int) value); }
+
+    static Vec Add(Vec a, Vec b) { return _mm512_add_epi32(a, b); }
+    static Vec Sub(Vec a, Vec b) { return _mm512_sub_epi32(a, b); }
+    static Vec MulLo(Vec a, Vec b) { return _mm512_mullo_epi32(a, b); }
+    static Vec And(Vec a, Vec b) { return _mm512_and_si512(a, b); }
+    static Vec Xor(Vec a, Vec b) { return _mm512_xor_si512(a, b); }
+    static Vec MaxS(Vec a, Vec b) { return _mm512_max_epi32(a, b); }
+    static Vec ShiftRight(Vec a, int count) { return _mm512_srl_epi32(a, _mm_cvtsi32_si128(count)); }
+    static Vec Pow2(Vec exponent) { return _mm512_sllv_epi32(_mm512_set1_epi32(1), exponent); }
+    static Vec Clz(Vec a) { return _mm512_lzcnt_epi32(a); }
+
+    static Vec SqrtFloat(Vec a) { return _mm512_cvttps_epi32(_mm512_sqrt_ps(_mm512_cvtepi32_ps(a))); }
+
+    static Vec AddSat16(Vec a, Vec b) { return _mm512_adds_epi16(a, b); }
+    static Vec SubSat16(Vec a, Vec b) { return _mm512_subs_epi16(a, b); }
+    static Vec MulhRound16(Vec a, Vec b) { return _mm512_mulhrs_epi16(a, b); }
+    static Vec CmpEq16(Vec a, Vec b) { return _mm512_movm_epi16(_mm512_cmpeq_epi16_mask(a, b)); }
+    static Vec MaddPairs16(Vec a, Vec b) { return _mm512_madd_epi16(a, b); }
+
+    static Vec MulEven32(Vec a, Vec b) { return _mm512_mul_epi32(a, b); }
+    static Vec Add64(Vec a, Vec b) { return _mm512_add_epi64(a, b); }
+    static Vec ShiftRight64(Vec a, int count) { return _mm512_srl_epi64(a, _mm_cvtsi32_si128(count)); }
+    static Vec ShiftLeft64(Vec a, int count) { return _mm512_sll_epi64(a, _mm_cvtsi32_si128(count)); }
+
+    static Mask CmpEq(Vec a, Vec b) { return _mm512_cmpeq_epi32_mask(a, b); }
+    static Mask CmpGtU(Vec a, Vec b) { return _mm512_cmpgt_epu32_mask(a, b); }
+    static Mask Test(Vec a, Vec b) { return _mm512_test_epi32_mask(a, b); }
+
+    static Mask MaskAnd(Mask a, Mask b) { return a & b; }
+    static Mask MaskAndNot(Mask a, Mask b) { return a & ~b; }
+    static bool Any(Mask m) { return m != 0; }
+
+    static Vec Select(Mask mask, Vec if_true, Vec if_false) { return _mm512_mask_blend_epi32(mask, if_false, if_true); }
+
+    static Vec LookupPairs(const PairTable& t, Vec index) {
+        if (t.num_registers == 2) {
+            return _mm512_permutex2var_epi32(t.pairs[0], index, t.pairs[1]);
+        }
+        else if (t.num_registers == 4) {
+            __m512i low = _mm512_permutex2var_epi32(t.pairs[0], index, t.pairs[1]);
+            __m512i high = _mm512_permutex2var_epi32(t.pairs[2], index, t.pairs[3]);
+            return _mm512_mask_blend_epi32(_mm512_test_epi32_mask(index, _mm512_set1_epi32(32)), low, high);
+        }
+        else {
+            return _mm512_i32gather_epi32(index, t.table, 2);
+        }
+    }
+
+    static Vec Gather(const void* base, Vec offset) { return _mm512_i32gather_epi32(offset, base, 1); }
+};
+
+#endif
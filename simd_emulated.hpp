@@ -0,0 +1,224 @@
+#ifndef FIXED_POINT_MATH_SIMD_EMULATED_HPP
+#define FIXED_POINT_MATH_SIMD_EMULATED_HPP
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "log2.hpp"
+
+// Plain C++ implementation of the SIMD backend interface used by batch_kernels.hpp.
+// It documents the exact semantics every backend must match, and runs the kernel templates as the scalar batch
+// kernels (batch_scalar.cpp), on any CPU. The lanes are simple enough loops for the compiler to vectorize where the
+// target allows.
+
+struct SimdEmulated {
+    static constexpr int width = 8;
+
+    struct Vec {
+        uint32_t lane[width];
+    };
+
+    // all ones or all zeros per lane, which keeps Select free of branches
+    using Mask = Vec;
+
+    // Lanes of a lookup table of 32-bit pairs (table[i], table[i + 1]); see LookupPairs
+    struct PairTable {
+        const uint16_t* table;
+
+        PairTable(const uint16_t* table, int /* num_pairs */) : table(table) {}
+    };
+
+    static Vec Load(const void* ptr) {
+        Vec v;
+        memcpy(v.lane, ptr, sizeof(v.lane));
+        return v;
+    }
+
+    // Loads count < width lanes, the rest are zero
+    static Vec LoadPartial(const void* ptr, size_t count) {
+        Vec v = {};
+        memcpy(v.lane, ptr, count * sizeof(uint32_t));
+        return v;
+    }
+
+    static void Store(void* ptr, Vec v) {
+        memcpy(ptr, v.lane, sizeof(v.lane));
+    }
+
+    static void StorePartial(void* ptr, Vec v, size_t count) {
+        memcpy(ptr, v.lane, count * sizeof(uint32_t));
+    }
+
+    static Vec Set1(uint32_t value) {
+        Vec v;
+
+        for (auto& lane : v.lane) {
+            lane = value;
+        }
+
+        return v;
+    }
+
+    template <typename Op>
+    static Vec Map(Vec a, Vec b, Op op) {
+        Vec v;
+
+        for (int i = 0; i < width; i++) {
+            v.lane[i] = op(a.lane[i], b.lane[i]);
+        }
+
+        return v;
+    }
+
+    template <typename Op>
+    static Mask Compare(Vec a, Vec b, Op op) {
+        return Map(a, b, [op](uint32_t x, uint32_t y) { return op(x, y) ? ~UINT32_C(0) : 0; });
+    }
+
+    // Wrap-around arithmetic
+    static Vec Add(Vec a, Vec b) { return Map(a, b, [](uint32_t x, uint32_t y) { return x + y; }); }
+    static Vec Sub(Vec a, Vec b) { return Map(a, b, [](uint32_t x, uint32_t y) { return x - y; }); }
+    static Vec MulLo(Vec a, Vec b) { return Map(a, b, [](uint32_t x, uint32_t y) { return x * y; }); }
+
+    static Vec And(Vec a, Vec b) { return Map(a, b, [](uint32_t x, uint32_t y) { return x & y; }); }
+    static Vec Xor(Vec a, Vec b) { return Map(a, b, [](uint32_t x, uint32_t y) { return x ^ y; }); }
+
+    // Signed maximum
+    static Vec MaxS(Vec a, Vec b) {
+        return Map(a, b, [](uint32_t x, uint32_t y) { return (int32_t) x > (int32_t) y ? x : y; });
+    }
+
+    // Logical shift of every lane by the same count in 0..31
+    static Vec ShiftRight(Vec a, int count) {
+        return Map(a, a, [count](uint32_t x, uint32_t) { return x >> count; });
+    }
+
+    // 2**exponent, exponent in 0..30
+    static Vec Pow2(Vec exponent) {
+        return Map(exponent, exponent, [](uint32_t x, uint32_t) { return UINT32_C(1) << x; });
+    }
+
+    // Count of leading zero bits, 32 for 0
+    static Vec Clz(Vec a) {
+        return Map(a, a, [](uint32_t x, uint32_t) { return (uint32_t) (31 - Log2floor(x)); });
+    }
+
+    // sqrt in single precision, truncated; exact input conversion needs a < 2**24
+    static Vec SqrtFloat(Vec a) {
+        return Map(a, a, [](uint32_t x, uint32_t) { return (uint32_t) sqrtf((float) x); });
+    }
+
+    // The lanes as pairs of 16-bit elements, low half first
+    template <typename Op>
+    static Vec Map16(Vec a, Vec b, Op op) {
+        return Map(a, b, [op](uint32_t x, uint32_t y) {
+            uint32_t low = (uint16_t) op((int16_t) x, (int16_t) y);
+            uint32_t high = (uint16_t) op((int16_t) (x >> 16), (int16_t) (y >> 16));
+            return low | high << 16;
+        });
+    }
+
+    static int32_t Saturate16(int32_t x) { return x > INT16_MAX ? INT16_MAX : x < INT16_MIN ? INT16_MIN : x; }
+
+    // Saturating arithmetic on signed 16-bit elements
+    static Vec AddSat16(Vec a, Vec b) { return Map16(a, b, [](int32_t x, int32_t y) { return Saturate16(x + y); }); }
+    static Vec SubSat16(Vec a, Vec b) { return Map16(a, b, [](int32_t x, int32_t y) { return Saturate16(x - y); }); }
+
+    // (x y + 2**14) >> 15 on signed 16-bit elements, keeping the low 16 bits: -1 * -1 wraps to INT16_MIN
+    static Vec MulhRound16(Vec a, Vec b) {
+        return Map16(a, b, [](int32_t x, int32_t y) { return (x * y + (1 << 14)) >> 15; });
+    }
+
+    // All ones in the 16-bit elements that are equal, zero elsewhere
+    static Vec CmpEq16(Vec a, Vec b) { return Map16(a, b, [](int32_t x, int32_t y) { return x == y ? -1 : 0; }); }
+
+    // Sum of the products of the two signed 16-bit elements of every lane, modulo 2**32: only
+    // -1 * -1 + -1 * -1 = 2**31 wraps, to INT32_MIN
+    static Vec MaddPairs16(Vec a, Vec b) {
+        return Map(a, b, [](uint32_t x, uint32_t y) {
+            return (uint32_t) ((int16_t) x * (int16_t) y) + (uint32_t) ((int16_t) (x >> 16) * (int16_t) (y >> 16));
+        });
+    }
+
+    // Lanes 2k and 2k + 1 as one 64-bit lane, low half first
+    template <typename Op>
+    static Vec Map64(Vec a, Vec b, Op op) {
+        Vec v;
+
+        for (int i = 0; i < width; i += 2) {
+            uint64_t x = a.lane[i] | (uint64_t) a.lane[i + 1] << 32;
+            uint64_t y = b.lane[i] | (uint64_t) b.lane[i + 1] << 32;
+            uint64_t r = op(x, y);
+
+            v.lane[i] = (uint32_t) r;
+            v.lane[i + 1] = (uint32_t) (r >> 32);
+        }
+
+        return v;
+    }
+
+    // Full product of the low halves of the 64-bit lanes, as signed 32-bit numbers
+    static Vec MulEven32(Vec a, Vec b) {
+        return Map64(a, b, [](uint64_t x, uint64_t y) { return (uint64_t) ((int64_t) (int32_t) x * (int32_t) y); });
+    }
+
+    // Wrap-around addition and logical shifts of 64-bit lanes, the shifts by the same count in 0..63
+    static Vec Add64(Vec a, Vec b) { return Map64(a, b, [](uint64_t x, uint64_t y) { return x + y; }); }
+
+    static Vec ShiftRight64(Vec a, int count) {
+        return Map64(a, a, [count](uint64_t x, uint64_t) { return x >> count; });
+    }
+
+    static Vec ShiftLeft64(Vec a, int count) {
+        return Map64(a, a, [count](uint64_t x, uint64_t) { return x << count; });
+    }
+
+    static Mask CmpEq(Vec a, Vec b) { return Compare(a, b, [](uint32_t x, uint32_t y) { return x == y; }); }
+    static Mask CmpGtU(Vec a, Vec b) { return Compare(a, b, [](uint32_t x, uint32_t y) { return x > y; }); }
+    // (a & b) != 0
+    static Mask Test(Vec a, Vec b) { return Compare(a, b, [](uint32_t x, uint32_t y) { return (x & y) != 0; }); }
+
+    static Mask MaskAnd(Mask a, Mask b) { return And(a, b); }
+    // a & ~b
+    static Mask MaskAndNot(Mask a, Mask b) { return Map(a, b, [](uint32_t x, uint32_t y) { return x & ~y; }); }
+
+    static bool Any(Mask m) {
+        uint32_t any = 0;
+
+        for (auto lane : m.lane) {
+            any |= lane;
+        }
+
+        return any != 0;
+    }
+
+    // mask ? if_true : if_false, per lane
+    static Vec Select(Mask mask, Vec if_true, Vec if_false) {
+        Vec v;
+
+        for (int i = 0; i < width; i++) {
+            v.lane[i] = (if_true.lane[i] & mask.lane[i]) | (if_false.lane[i] & ~mask.lane[i]);
+        }
+
+        return v;
+    }
+
+    // table[index] | table[index + 1] << 16, per lane
+    static Vec LookupPairs(const PairTable& t, Vec index) {
+        return Map(index, index, [&t](uint32_t i, uint32_t) {
+            return t.table[i] | (uint32_t) t.table[i + 1] << 16;
+        });
+    }
+
+    // The 4 bytes at byte offset `offset` from `base` as a little-endian word, per lane; offsets need not be aligned
+    static Vec Gather(const void* base, Vec offset) {
+        return Map(offset, offset, [base](uint32_t o, uint32_t) {
+            const uint8_t* bytes = (const uint8_t*) base + o;
+            return bytes[0] | (uint32_t) bytes[1] << 8 | (uint32_t) bytes[2] << 16 | (uint32_t) bytes[3] << 24;
+        });
+    }
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef FIXED_POINT_MATH_SIMD_SSE42_HPP
+#define FIXED_POINT_MATH_SIMD_SSE42_HPP
+
+#include <nmmintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// SSE4.2 backend for batch_kernels.hpp, 4 lanes. Only include from a file compiled with -msse4.2.
+
+struct SimdSse42 {
+    static constexpr int width = 4;
+
+    using Vec = __m128i;
+    using Mask = __m128i;
+
+    struct PairTable {
+        const uint16_t* table;
+
+        PairTable(const uint16_t* table, int /* num_pairs */) : table(table) {}
+    };
+
+    static Vec Load(const void* ptr) { return _mm_loadu_si128((const __m128i*) ptr); }
+    static void Store(void* ptr, Vec v) { _mm_storeu_si128((__m128i*) ptr, v); }
+
+    static Vec LoadPartial(const void* ptr, size_t count) {
+        uint32_t lanes[width] = {};
+        memcpy(lanes, ptr, count * sizeof(uint32_t));
+        return Load(lanes);
+    }
+
+    static void StorePartial(void* ptr, Vec v, size_t count) {
+        uint32_t lanes[width];
+        Store(lanes, v);
+        memcpy(ptr, lanes, count * sizeof(uint32_t));
+    }
+
+    static Vec Set1(uint32_t value) { return _mm_set1_epi32((int) value); }
+
+    static Vec Add(Vec a, Vec b) { return _mm_add_epi32(a, b); }
+    static Vec Sub(Vec a, Vec b) { return _mm_sub_epi32(a, b); }
+    static Vec MulLo(Vec a, Vec b) { return _mm_mullo_epi32(a, b); }
+    static Vec And(Vec a, Vec b) { return _mm_and_si128(a, b); }
+    static Vec Xor(Vec a, Vec b) { return _mm_xor_si128(a, b); }
+    static Vec MaxS(Vec a, Vec b) { return _mm_max_epi32(a, b); }
+    static Vec ShiftRight(Vec a, int count) { return _mm_srl_epi32(a, _mm_cvtsi32_si128(count)); }
+
+    // by way of the float exponent field
+    static Vec Pow2(Vec exponent) {
+        __m128i as_float = _mm_slli_epi32(_mm_add_epi32(exponent, _mm_set1_epi32(127)), 23);
+        return _mm_cvttps_epi32(_mm_castsi128_ps(as_float));
+    }
+
+    // LogTable256 split into nibbles for pshufb: the count of a byte is that of its high nibble, or 4 more than that
+    // of its low nibble when the high one is zero. Mapping a zero high nibble to 8 lets an unsigned minimum decide.
+    static Vec Clz(Vec v) {
+        const __m128i high_table = _mm_setr_epi8(8, 3, 2, 2, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0);
+        const __m128i low_table = _mm_setr_epi8(8, 7, 6, 6, 5, 5, 5, 5, 4, 4, 4, 4, 4, 4, 4, 4);
+        const __m128i nibble_mask = _mm_set1_epi8(0x0f);
+
+        __m128i high = _mm_shuffle_epi8(high_table, _mm_and_si128(_mm_srli_epi16(v, 4), nibble_mask));
+        __m128i low = _mm_shuffle_epi8(low_table, _mm_and_si128(v, nibble_mask));
+        __m128i bytes = _mm_min_epu8(high, low);
+
+        // then the same for the halves of 16-bit words, and of 32-bit lanes
+        __m128i high_bytes = _mm_srli_epi16(bytes, 8);
+        __m128i low_bytes = _mm_and_si128(bytes, _mm_set1_epi16(0xff));
+        __m128i words = _mm_add_epi16(high_bytes,
+                                      _mm_and_si128(_mm_cmpeq_epi16(high_bytes, _mm_set1_epi16(8)), low_bytes));
+
+        __m128i high_words = _mm_srli_epi32(words, 16);
+        __m128i low_words = _mm_and_si128(words, _mm_set1_epi32(0xffff));
+        return _mm_add_epi32(high_words,
+                             _mm_and_si128(_mm_cmpeq_epi32(high_words, _mm_set1_epi32(16)), low_words));
+    }
+
+    static Vec SqrtFloat(Vec a) { return _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(a))); }
+
+    static Vec AddSat16(Vec a, Vec b) { return _mm_adds_epi16(a, b); }
+    static Vec SubSat16(Vec a, Vec b) { return _mm_subs_epi16(a, b); }
+    static Vec MulhRound16(Vec a, Vec b) { return _mm_mulhrs_epi16(a, b); }
+    static Vec CmpEq16(Vec a, Vec b) { return _mm_cmpeq_epi16(a, b); }
+    static Vec MaddPairs16(Vec a, Vec b) { return _mm_madd_epi16(a, b); }
+
+    static Vec MulEven32(Vec a, Vec b) { return _mm_mul_epi32(a, b); }
+    static Vec Add64(Vec a, Vec b) { return _mm_add_epi64(a, b); }
+    static Vec ShiftRight64(Vec a, int count) { return _mm_srl_epi64(a, _mm_cvtsi32_si128(count)); }
+    static Vec ShiftLeft64(Vec a, int count) { return _mm_sll_epi64(a, _mm_cvtsi32_si128(count)); }
+
+    static Mask CmpEq(Vec a, Vec b) { return _mm_cmpeq_epi32(a, b); }
+    static Mask CmpGtU(Vec a, Vec b) { return _mm_xor_si128(_mm_cmpeq_epi32(_mm_max_epu32(a, b), b), _mm_set1_epi32(-1)); }
+    static Mask Test(Vec a, Vec b) { return _mm_xor_si128(CmpEq(And(a, b), _mm_setzero_si128()), _mm_set1_epi32(-1)); }
+
+    static Mask MaskAnd(Mask a, Mask b) { return _mm_and_si128(a, b); }
+    static Mask MaskAndNot(Mask a, Mask b) { return _mm_andnot_si128(b, a); }
+    static bool Any(Mask m) { return !_mm_testz_si128(m, m); }
+
+    static Vec Select(Mask mask, Vec if_true, Vec if_false) { return _mm_blendv_epi8(if_false, if_true, mask); }
+
+    // no gather before AVX2
+    static Vec LookupPairs(const PairTable& t, Vec index) {
+        return _mm_setr_epi32(LoadPair(t.table, _mm_extract_epi32(index, 0)),
+                              LoadPair(t.table, _mm_extract_epi32(index, 1)),
+                              LoadPair(t.table, _mm_extract_epi32(index, 2)),
+                              LoadPair(t.table, _mm_extract_epi32(index, 3)));
+    }
+
+    static Vec Gather(const void* base, Vec offset) {
+        return _mm_setr_epi32(LoadWord(base, _mm_extract_epi32(offset, 0)),
+                              LoadWord(base, _mm_extract_epi32(offset, 1)),
+                              LoadWord(base, _mm_extract_epi32(offset, 2)),
+                              LoadWord(base, _mm_extract_epi32(offset, 3)));
+    }
+
+private:
+    static int LoadPair(const uint16_t* table, int index) {
+        uint32_t pair;
+        memcpy(&pair, &table[index], sizeof(pair));
+        return (int) pair;
+    }
+
+    static int LoadWord(const void* base, int offset) {
+        uint32_t word;
+        memcpy(&word, (const uint8_t*) base + offset, sizeof(word));
+        return (int) word;
+    }
+};
+
+#endif
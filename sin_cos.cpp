@@ -2,54 +2,231 @@
 
 #include <doctest.h>
 
+#include <algorithm>
 #include <math.h>
 #include <stdio.h>
 
-#if SIN_TABLE_BITS == 5
-const uint16_t sin_table[33] = {
-    0x0000, 0x00c9, 0x0191, 0x0259, 0x031f, 0x03e3, 0x04a5, 0x0564,
-    0x061f, 0x06d7, 0x078b, 0x083a, 0x08e4, 0x0988, 0x0a26, 0x0abf,
-    0x0b50, 0x0bdb, 0x0c5e, 0x0cda, 0x0d4e, 0x0db9, 0x0e1c, 0x0e77,
-    0x0ec8, 0x0f11, 0x0f50, 0x0f85, 0x0fb1, 0x0fd4, 0x0fec, 0x0ffb,
-    0x1000,
-};
-#endif
+static_assert(sin_table[0] == 0 && sin_table[sin_table_size - 1] == 4096, "sin_table must span [0, 1]");
 
-#if SIN_TABLE_BITS == 6
-const uint16_t sin_table[65] = {
-    0x0000, 0x0065, 0x00c9, 0x012d, 0x0191, 0x01f5, 0x0259, 0x02bc,
-    0x031f, 0x0381, 0x03e3, 0x0444, 0x04a5, 0x0505, 0x0564, 0x05c2,
-    0x061f, 0x067c, 0x06d7, 0x0732, 0x078b, 0x07e3, 0x083a, 0x088f,
-    0x08e4, 0x0937, 0x0988, 0x09d8, 0x0a26, 0x0a73, 0x0abf, 0x0b08,
-    0x0b50, 0x0b97, 0x0bdb, 0x0c1e, 0x0c5e, 0x0c9d, 0x0cda, 0x0d15,
-    0x0d4e, 0x0d85, 0x0db9, 0x0dec, 0x0e1c, 0x0e4b, 0x0e77, 0x0ea1,
-    0x0ec8, 0x0eee, 0x0f11, 0x0f31, 0x0f50, 0x0f6c, 0x0f85, 0x0f9c,
-    0x0fb1, 0x0fc4, 0x0fd4, 0x0fe1, 0x0fec, 0x0ff5, 0x0ffb, 0x0fff,
-    0x1000,
-};
-#endif
+// Every entry against libm, rounded to nearest
+template <typename T, int table_bits, int frac_bits>
+static void CheckSinTable(const T (&table)[SinTable<T, table_bits, frac_bits>::size]) {
+    const size_t quarter = (size_t) 1 << table_bits;
 
-#if SIN_TABLE_BITS == 7
-const uint16_t sin_table[129] = {
-    0x0000, 0x0032, 0x0065, 0x0097, 0x00c9, 0x00fb, 0x012d, 0x015f,
-    0x0191, 0x01c3, 0x01f5, 0x0227, 0x0259, 0x028b, 0x02bc, 0x02ee,
-    0x031f, 0x0350, 0x0381, 0x03b2, 0x03e3, 0x0414, 0x0444, 0x0475,
-    0x04a5, 0x04d5, 0x0505, 0x0534, 0x0564, 0x0593, 0x05c2, 0x05f1,
-    0x061f, 0x064e, 0x067c, 0x06aa, 0x06d7, 0x0705, 0x0732, 0x075e,
-    0x078b, 0x07b7, 0x07e3, 0x080e, 0x083a, 0x0865, 0x088f, 0x08ba,
-    0x08e4, 0x090d, 0x0937, 0x095f, 0x0988, 0x09b0, 0x09d8, 0x09ff,
-    0x0a26, 0x0a4d, 0x0a73, 0x0a99, 0x0abf, 0x0ae4, 0x0b08, 0x0b2d,
-    0x0b50, 0x0b74, 0x0b97, 0x0bb9, 0x0bdb, 0x0bfc, 0x0c1e, 0x0c3e,
-    0x0c5e, 0x0c7e, 0x0c9d, 0x0cbc, 0x0cda, 0x0cf8, 0x0d15, 0x0d32,
-    0x0d4e, 0x0d69, 0x0d85, 0x0d9f, 0x0db9, 0x0dd3, 0x0dec, 0x0e04,
-    0x0e1c, 0x0e34, 0x0e4b, 0x0e61, 0x0e77, 0x0e8c, 0x0ea1, 0x0eb5,
-    0x0ec8, 0x0edb, 0x0eee, 0x0eff, 0x0f11, 0x0f21, 0x0f31, 0x0f41,
-    0x0f50, 0x0f5e, 0x0f6c, 0x0f79, 0x0f85, 0x0f91, 0x0f9c, 0x0fa7,
-    0x0fb1, 0x0fbb, 0x0fc4, 0x0fcc, 0x0fd4, 0x0fdb, 0x0fe1, 0x0fe7,
-    0x0fec, 0x0ff1, 0x0ff5, 0x0ff8, 0x0ffb, 0x0ffd, 0x0fff, 0x1000,
-    0x1000,
-};
-#endif
+    for (size_t i = 0; i <= quarter; i++) {
+        double exact = sin((double) i / (double) quarter * M_PI / 2) * ldexp(1, frac_bits);
+
+        INFO("table_bits = " << table_bits << ", frac_bits = " << frac_bits << ", i = " << i);
+        REQUIRE_EQ((int64_t) table[i], (int64_t) round(exact));
+    }
+}
+
+TEST_CASE("SinTable") {
+    CheckSinTable<uint16_t, SIN_TABLE_BITS, 12>(sin_table);
+    CheckSinTable<uint32_t, SIN_FINE_TABLE_BITS, 20>(sin_fine_table);
+
+    // other sizes come for free
+    CheckSinTable<uint16_t, 5, 12>(sin_table_v<uint16_t, 5, 12>.values);
+    CheckSinTable<uint16_t, 7, 12>(sin_table_v<uint16_t, 7, 12>.values);
+    CheckSinTable<uint16_t, 8, 12>(sin_table_v<uint16_t, 8, 12>.values);
+    CheckSinTable<uint16_t, 12, 15>(sin_table_v<uint16_t, 12, 15>.values);
+    CheckSinTable<uint32_t, 10, 30>(sin_table_v<uint32_t, 10, 30>.values);
+    CheckSinTable<uint32_t, 16, 30>(sin_table_v<uint32_t, 16, 30>.values);
+    CheckSinTable<uint64_t, SIN_Q30_COARSE_BITS, 36>(sin_table_v<uint64_t, SIN_Q30_COARSE_BITS, 36>.values);
+}
+
+// Every angle against libm, correctly rounded; half-way cases cannot occur, since sin(x) is irrational for these x
+template <int angle_bits>
+static void CheckSinDirect() {
+    constexpr int32_t num_angles = INT32_C(1) << angle_bits;
+
+    for (int32_t angle = 0; angle < num_angles; angle++) {
+        INFO("angle_bits = " << angle_bits << ", angle = " << angle);
+
+        REQUIRE_EQ(SinDirect<angle_bits, int32_t>(angle), (int32_t) round(4096 * sin(2 * M_PI * angle / num_angles)));
+        REQUIRE_EQ(SinDirect<angle_bits, int32_t>(angle), SinDirect<angle_bits, int32_t>(angle + num_angles));
+        REQUIRE_EQ(SinDirect<angle_bits, int32_t>(angle), SinDirect<angle_bits, int32_t>(angle - num_angles));
+    }
+}
+
+TEST_CASE("SinDirect") {
+    // full-period tables
+    CheckSinDirect<2>();
+    CheckSinDirect<3>();
+    CheckSinDirect<5>();
+    CheckSinDirect<8>();
+
+    // quarter-wave tables
+    CheckSinDirect<9>();
+    CheckSinDirect<12>();
+    CheckSinDirect<16>();
+
+    // Sin takes this path where there is nothing to interpolate, and agrees with the interpolation where both apply
+    for (int32_t angle = -300; angle < 300; angle++) {
+        REQUIRE_EQ(Sin<4, int32_t>(angle), SinDirect<4, int32_t>(angle));
+        REQUIRE_EQ(Cos<4, int32_t>(angle), SinDirect<4, int32_t>(angle + 4));
+        REQUIRE_EQ(Sin<SIN_TABLE_BITS + 2, int32_t>(angle), SinInterpolated<SIN_TABLE_BITS + 2, int32_t>(angle));
+    }
+
+    // 8-bit angles in their natural types
+    for (int32_t i = INT8_MIN; i <= INT8_MAX; i++) {
+        REQUIRE_EQ(Sin<8, int8_t>((int8_t) i), Sin<8, int32_t>(i & 0xff));
+        REQUIRE_EQ(Sin<8, uint8_t>((uint8_t) i), Sin<8, int32_t>(i & 0xff));
+    }
+
+    CHECK_EQ(Sin<8, uint8_t>(64), 4096);
+    CHECK_EQ(Sin<8, int8_t>(-64), -4096);
+    CHECK_EQ(Cos<8, uint8_t>(128), -4096);
+}
+
+template <int table_bits>
+static void CheckSinDeltaTable() {
+    const auto& delta_table = sin_delta_table_v<table_bits>;
+    const auto& plain_table = sin_table_v<uint16_t, table_bits, 12>.values;
+
+    uint16_t decoded[SinTable<uint16_t, table_bits, 12>::size];
+    delta_table.Decode(decoded);
+
+    for (size_t i = 0; i <= delta_table.num_steps; i++) {
+        INFO("table_bits = " << table_bits << ", i = " << i);
+
+        REQUIRE_EQ(decoded[i], plain_table[i]);
+        REQUIRE_EQ(delta_table.Value(i), plain_table[i]);
+
+        if (i < delta_table.num_steps) {
+            uint32_t value, step;
+            SinDeltaLookup(delta_table, (uint32_t) i, value, step);
+
+            REQUIRE_EQ(value, plain_table[i]);
+            REQUIRE_EQ(step, plain_table[i + 1] - plain_table[i]);
+        }
+    }
+}
+
+TEST_CASE("SinDelta") {
+    // 5 bits has the largest steps that still fit in a byte
+    CheckSinDeltaTable<5>();
+    CheckSinDeltaTable<6>();
+    CheckSinDeltaTable<7>();
+    CheckSinDeltaTable<10>();
+
+    static_assert(sizeof(sin_delta_table_v<7>.steps) + sizeof(sin_delta_table_v<7>.bases) == 160,
+                  "128 steps and 16 bases");
+
+    // the same interpolation from the same values
+    for (int32_t angle = 0; angle < 65536; angle++) {
+        REQUIRE_EQ(SinDelta<16, int32_t>(angle), Sin<16, int32_t>(angle));
+        REQUIRE_EQ(SinDelta<12, int32_t>(angle), Sin<12, int32_t>(angle));
+        REQUIRE_EQ(SinDelta<SIN_TABLE_BITS + 2, int32_t>(angle), Sin<SIN_TABLE_BITS + 2, int32_t>(angle));
+        REQUIRE_EQ(SinDelta<16, int16_t>((int16_t) angle), Sin<16, int16_t>((int16_t) angle));
+    }
+
+    for (uint32_t angle = 0; angle < 0xffff0000u; angle += 65521) {
+        REQUIRE_EQ(SinDelta<32, uint32_t>(angle), Sin<32, uint32_t>(angle));
+        REQUIRE_EQ(SinDelta<24, uint32_t>(angle), Sin<24, uint32_t>(angle));
+    }
+}
+
+// Largest difference from 4096 sin(x) and 4096 cos(x), over every step-th angle
+template <int angle_bits>
+static double SinCosOctantMaxError(uint32_t step) {
+    constexpr uint64_t num_angles = UINT64_C(1) << angle_bits;
+    double max_error = 0;
+
+    for (uint64_t angle = 0; angle < num_angles; angle += step) {
+        int32_t sin_value, cos_value;
+        SinCosOctant<angle_bits, uint32_t>((uint32_t) angle, sin_value, cos_value);
+
+        double x = 2 * M_PI * (double) angle / (double) num_angles;
+        max_error = std::max(max_error, fabs(sin_value - 4096 * sin(x)));
+        max_error = std::max(max_error, fabs(cos_value - 4096 * cos(x)));
+    }
+
+    return max_error;
+}
+
+TEST_CASE("SinCosOctant") {
+    // half of a quarter-wave table of the same resolution
+    static_assert(sizeof(sin_octant_table) < sizeof(sin_table_v<uint16_t, SIN_OCTANT_TABLE_BITS + 1, 12>) / 2 + 4,
+                  "octant table too large");
+
+    for (int i = 0; i < (1 << SIN_OCTANT_TABLE_BITS) + 2; i++) {
+        INFO("i = " << i);
+        REQUIRE_EQ(sin_octant_table[i], (int32_t) round(65536 * sin(M_PI / 4 * i / (1 << SIN_OCTANT_TABLE_BITS))));
+    }
+
+    CHECK_LE(SinCosOctantMaxError<8>(1), 0.75);
+    CHECK_LE(SinCosOctantMaxError<12>(1), 0.75);
+    CHECK_LE(SinCosOctantMaxError<16>(1), 0.75);
+    CHECK_LE(SinCosOctantMaxError<24>(97), 0.75);
+    CHECK_LE(SinCosOctantMaxError<32>(65537), 0.75);
+
+    // exact at the axes
+    const int32_t axis_sin[] = {0, 4096, 0, -4096};
+    const int32_t axis_cos[] = {4096, 0, -4096, 0};
+
+    for (int32_t quadrant = 0; quadrant < 4; quadrant++) {
+        CHECK_EQ(SinOctant<16, int32_t>(quadrant << 14), axis_sin[quadrant]);
+        CHECK_EQ(CosOctant<16, int32_t>(quadrant << 14), axis_cos[quadrant]);
+    }
+
+    for (int32_t angle = -70000; angle < 70000; angle++) {
+        REQUIRE_EQ(SinOctant<16, int32_t>(angle), SinOctant<16, int32_t>(angle & 0xffff));
+        REQUIRE_EQ(SinOctant<16, int16_t>((int16_t) angle), SinOctant<16, int32_t>(angle));
+        REQUIRE_EQ(SinOctant<16, int32_t>(angle + (1 << 14)), CosOctant<16, int32_t>(angle));
+        REQUIRE_EQ(SinOctant<16, int32_t>(-angle), -SinOctant<16, int32_t>(angle));
+    }
+}
+
+// Largest difference from 2**30 sin(x), over every step-th angle starting at offset
+template <int angle_bits>
+static double SinQ30MaxError(uint64_t step, uint64_t offset) {
+    constexpr uint64_t num_angles = UINT64_C(1) << angle_bits;
+    double max_error = 0;
+
+    for (uint64_t angle = offset; angle < num_angles; angle += step) {
+        long double exact = ldexpl(sinl(2 * 3.14159265358979323846264338327950288L * angle / num_angles), 30);
+        double error = (double) fabsl(SinQ30<angle_bits, uint32_t>((uint32_t) angle) - exact);
+
+        if (error > max_error) {
+            max_error = error;
+        }
+    }
+
+    return max_error;
+}
+
+TEST_CASE("SinQ30") {
+    CHECK_LE(SinQ30MaxError<12>(1, 0), 0.53);
+    CHECK_LE(SinQ30MaxError<24>(1, 0), 0.53);
+    CHECK_LE(SinQ30MaxError<28>(61, 7), 0.53);
+    CHECK_LE(SinQ30MaxError<32>(997, 13), 0.53);
+
+    // the coarse table boundaries, where the fine part wraps around
+    for (uint32_t coarse = 0; coarse <= (1 << SIN_Q30_COARSE_BITS); coarse++) {
+        uint32_t boundary = coarse << (30 - SIN_Q30_COARSE_BITS);
+
+        for (uint32_t offset : {boundary - 1, boundary, boundary + 1}) {
+            long double exact = ldexpl(sinl(3.14159265358979323846264338327950288L / 2 * offset / (1u << 30)), 30);
+
+            INFO("angle = " << offset);
+            REQUIRE_LE(fabsl(SinQ30<32, uint32_t>(offset) - exact), 0.53L);
+        }
+    }
+
+    CHECK_EQ(SinQ30<32, uint32_t>(0), 0);
+    CHECK_EQ(SinQ30<32, uint32_t>(UINT32_C(1) << 30), 1 << 30);
+    CHECK_EQ(SinQ30<32, uint32_t>(UINT32_C(3) << 30), -(1 << 30));
+    CHECK_EQ(CosQ30<32, uint32_t>(0), 1 << 30);
+    CHECK_EQ(CosQ30<24, int32_t>(1 << 23), -(1 << 30));
+
+    // signed and wrapped angles fold like Sin
+    for (int32_t angle = -5000; angle < 5000; angle += 7) {
+        REQUIRE_EQ(SinQ30<24, int32_t>(angle), SinQ30<24, uint32_t>((uint32_t) angle & 0xffffff));
+        REQUIRE_EQ(SinQ30<32, int32_t>(angle), -SinQ30<32, int32_t>(-angle));
+        REQUIRE_EQ(CosQ30<32, int32_t>(angle), CosQ30<32, int32_t>(-angle));
+    }
+}
 
 static void DemoSin(int32_t i) {
     auto got = Sin<12, int32_t>(i);
@@ -58,6 +235,8 @@ static void DemoSin(int32_t i) {
     printf("CHECK_EQ(Sin<12, int32_t>(%4d), %5d);\n", i, got);
 }
 
+// Reference values of the default table; other sizes round differently here and there
+#if SIN_TABLE_BITS == 6
 TEST_CASE("Sin<12, int32_t>(int32_t)") {
     CHECK_EQ(Sin<12, int32_t>(   0),     0);
     CHECK_EQ(Sin<12, int32_t>(   1),     6);
@@ -153,6 +332,7 @@ TEST_CASE("Sin<12, int32_t>(int32_t)") {
     printf("TOTAL ERROR: %f\tTOTAL BIAS: %f\tMAX ERROR: %f\n", total_error, total_bias, max_error);
     */
 }
+#endif
 
 static void DemoCos(int32_t i) {
     auto got = Cos<12, int32_t>(i);
@@ -161,6 +341,7 @@ static void DemoCos(int32_t i) {
     printf("CHECK_EQ(Cos<12, int32_t>(%4d), %5d);\n", i, got);
 }
 
+#if SIN_TABLE_BITS == 6
 TEST_CASE("Cos<12, int32_t>(int32_t)") {
     CHECK_EQ(Cos<12, int32_t>(   0),  4096);
     CHECK_EQ(Cos<12, int32_t>(   1),  4096);
@@ -256,3 +437,18 @@ TEST_CASE("Cos<12, int32_t>(int32_t)") {
     printf("TOTAL ERROR: %f\tTOTAL BIAS: %f\tMAX ERROR: %f\n", total_error, total_bias, max_error);
     */
 }
+#endif
+
+TEST_CASE("Sin<16, int16_t>(int16_t), Cos<16, int16_t>(int16_t)") {
+    // Narrow signed angles must give the same result as the same bit pattern in a wider type
+    for (int32_t i = INT16_MIN; i <= INT16_MAX; i++) {
+        REQUIRE_EQ(Sin<16, int16_t>((int16_t) i), Sin<16, int32_t>(i & 0xffff));
+        REQUIRE_EQ(Cos<16, int16_t>((int16_t) i), Cos<16, int32_t>(i & 0xffff));
+    }
+
+    CHECK_EQ(Sin<16, int16_t>(INT16_MIN), 0);
+    CHECK_EQ(Sin<16, int16_t>(-16384), -4096);
+    CHECK_EQ(Cos<16, int16_t>(INT16_MIN), -4096);
+    CHECK_EQ(Cos<16, int16_t>(INT16_MAX), -4096);
+    CHECK_EQ(Cos<16, int16_t>(-1), 4096);
+}
@@ -2,59 +2,106 @@
 #define FIXED_POINT_MATH_SIN_COS_HPP
 
 #include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+
+#include "arith.hpp"
+#include "instrument.hpp"
+#include "sin_table.hpp"
 
 // 5 bits: TOTAL ERROR: 2390.284424	TOTAL BIAS: 0.000016	MAX ERROR: 1.847876
 // 6 bits: TOTAL ERROR: 1239.927612	TOTAL BIAS: -0.000005	MAX ERROR: 1.049462
 // 7 bits: TOTAL ERROR: 1193.813843	TOTAL BIAS: 0.000000	MAX ERROR: 0.931593
 // 8 bits: TOTAL ERROR: 1193.655884	TOTAL BIAS: 0.000008	MAX ERROR: 0.972333
+// The table is generated at compile time, so any size from 5 to 10 bits can be picked here (or with -D). Below 5 bits
+// the steps no longer fit in the bytes of sin_delta_table_v and the AVX2 int16 kernels; above 10, the tests' 12-bit
+// angles would be narrower than SIN_TABLE_BITS + 2.
+#ifndef SIN_TABLE_BITS
 #define SIN_TABLE_BITS 6
-
-#if SIN_TABLE_BITS == 5
-extern const uint16_t sin_table[33];
-#endif
-
-#if SIN_TABLE_BITS == 6
-extern const uint16_t sin_table[65];
 #endif
 
-#if SIN_TABLE_BITS == 7
-extern const uint16_t sin_table[129];
-#endif
+static_assert(SIN_TABLE_BITS >= 5 && SIN_TABLE_BITS <= 10, "SIN_TABLE_BITS must be between 5 and 10");
 
 constexpr int sin_table_size = (1 << SIN_TABLE_BITS) + 1;
+
+// sin over [0, pi/2] with 12 fractional bits
+inline constexpr const uint16_t (&sin_table)[sin_table_size] = sin_table_v<uint16_t, SIN_TABLE_BITS, 12>.values;
+
 constexpr int index_mask = (1 << SIN_TABLE_BITS) - 1;
 
 // Input bit width is configurable, output is currently fixed at 1+12 bits (range of +/- 0x1000)
 // Tabulated values are interpolated linearly, so a table of 2**6 entries already gives good results.
+//
+// Angles no finer than sin_table, as used for LEDs or motor commutation, leave nothing to interpolate. Up to
+// SIN_PERIOD_MAX_ANGLE_BITS Sin is then a single load from a table over the whole turn, above that it reads a
+// quarter-wave table of exactly the angle's resolution. Either way the result is 4096 sin(x) correctly rounded, the
+// same as the interpolation gives for angle_bits = SIN_TABLE_BITS + 2.
+constexpr int SIN_PERIOD_MAX_ANGLE_BITS = 8;
+constexpr int SIN_DIRECT_MAX_ANGLE_BITS = SIN_TABLE_BITS + 2;
 
+// Correctly rounded table lookup for any angle_bits; Sin uses it up to SIN_DIRECT_MAX_ANGLE_BITS, and it can be
+// called directly for finer angles too, at the cost of a table of 2**(angle_bits - 2) entries
 template <int angle_bits, typename Angle_t>
-int32_t Sin(Angle_t angle) {
+int32_t SinDirect(Angle_t angle) {
+    static_assert(angle_bits >= 2 && angle_bits <= 16, "angle_bits must be between 2 and 16");
+
+    uint32_t bits = (uint32_t) angle;
+
+    if constexpr (angle_bits <= SIN_PERIOD_MAX_ANGLE_BITS) {
+        return sin_period_table_v<int16_t, angle_bits, 12>.values[bits & ((UINT32_C(1) << angle_bits) - 1)];
+    }
+    else {
+        constexpr uint32_t quarter = UINT32_C(1) << (angle_bits - 2);
+        const auto& quarter_wave = sin_table_v<uint16_t, angle_bits - 2, 12>.values;
+
+        uint32_t index = bits & (quarter - 1);
+
+        if ((bits & quarter) != 0) {
+            index = quarter - index;
+        }
+
+        int32_t value = quarter_wave[index];
+        return (bits & (quarter << 1)) == 0 ? value : -value;
+    }
+}
+
+template <int angle_bits, typename Angle_t>
+int32_t SinInterpolated(Angle_t angle) {
     // number of bits per 0.5pi radians
     constexpr int interp_bits = (angle_bits - 2 - SIN_TABLE_BITS);
 
-    constexpr int interp_max = (1 << interp_bits);
-    constexpr int interp_mask = (1 << interp_bits) - 1;
+    static_assert(interp_bits >= 0, "angle_bits must be at least SIN_TABLE_BITS + 2");
+    static_assert(angle_bits <= 32, "angle_bits must fit in 32 bits");
 
-    constexpr int angle_half_bit = 1 << (angle_bits - 1);
-    constexpr int angle_quarter_bit = 1 << (angle_bits - 2);
+    constexpr uint32_t interp_max = (UINT32_C(1) << interp_bits);
+    constexpr uint32_t interp_mask = (UINT32_C(1) << interp_bits) - 1;
 
-    int index, index2, interp_pos;
+    constexpr uint32_t angle_half_bit = UINT32_C(1) << (angle_bits - 1);
+    constexpr uint32_t angle_quarter_bit = UINT32_C(1) << (angle_bits - 2);
 
-    if ((angle & angle_quarter_bit) == 0) {
-        // 1st or 3rd quarter
-        index = (angle >> interp_bits) & index_mask;
-        index2 = index + 1;
-        interp_pos = angle & interp_mask;
-    }
-    else {
-        index = sin_table_size - 1 - ((angle >> interp_bits) & index_mask) - 1;
-        index2 = index + 1;
-        interp_pos = interp_max - (angle & interp_mask);
+    // The largest table step is below 2**12 * pi/2 / 2**SIN_TABLE_BITS < 2**(13 - SIN_TABLE_BITS), so the
+    // interpolation product only needs 64 bits for very wide angles
+    using Product_t = std::conditional_t<(interp_bits + 13 - SIN_TABLE_BITS < 32), uint32_t, uint64_t>;
+
+    // Only the low angle_bits of the two's complement representation matter, so all the folding is done unsigned.
+    // This turns every division and modulo into a plain shift or mask, also for narrow signed angle types.
+    uint32_t bits = (uint32_t) angle;
+
+    uint32_t index = (bits >> interp_bits) & index_mask;
+    uint32_t interp_pos = bits & interp_mask;
+
+    if ((bits & angle_quarter_bit) != 0) {
+        // 2nd or 4th quarter: mirror around 0.5pi; interp_pos may become interp_max here
+        index = index_mask - index;
+        interp_pos = interp_max - interp_pos;
     }
 
-    int32_t interpolated = (sin_table[index] + (((sin_table[index2] - sin_table[index]) * interp_pos + interp_max / 2) / interp_max));
+    // The table is increasing, so the step is never negative
+    uint32_t delta = sin_table[index + 1] - sin_table[index];
+    int32_t interpolated = sin_table[index] + (int32_t) ShiftRound<interp_bits>((Product_t) delta * interp_pos);
 
-    if ((angle & angle_half_bit) == 0) {
+    if ((bits & angle_half_bit) == 0) {
         return interpolated;
     }
     else {
@@ -62,11 +109,271 @@ int32_t Sin(Angle_t angle) {
     }
 }
 
+template <int angle_bits, typename Angle_t>
+int32_t Sin(Angle_t angle) {
+    static_assert(angle_bits >= 2 && angle_bits <= 32, "angle_bits must be between 2 and 32");
+
+    FIXED_POINT_MATH_INSTRUMENT_CALL("Sin", angle_bits, -1);
+
+    if constexpr (angle_bits <= SIN_DIRECT_MAX_ANGLE_BITS) {
+        return SinDirect<angle_bits, Angle_t>(angle);
+    }
+    else {
+        return SinInterpolated<angle_bits, Angle_t>(angle);
+    }
+}
+
+// values[index] and steps[index] of a SinDeltaTable without a loop: the steps before index in its block are masked
+// out of one 64-bit load, added pairwise into 16-bit lanes, and the lanes summed by a multiplication
+template <int table_bits>
+void SinDeltaLookup(const SinDeltaTable<table_bits>& table, uint32_t index, uint32_t& value, uint32_t& step) {
+    constexpr uint64_t low_bytes = UINT64_C(0x00ff00ff00ff00ff);
+    constexpr int block_mask = (1 << SIN_DELTA_BLOCK_BITS) - 1;
+
+    static_assert(block_mask == 7, "one group of steps per 64-bit load");
+
+    uint64_t steps;
+    memcpy(&steps, &table.steps[index & ~block_mask], sizeof(steps));
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    steps = __builtin_bswap64(steps);
+#endif
+
+    int position = (int) (index & block_mask);
+    uint64_t before = steps & ((UINT64_C(1) << (8 * position)) - 1);
+    uint64_t pairs = (before & low_bytes) + ((before >> 8) & low_bytes);
+
+    value = table.bases[index >> SIN_DELTA_BLOCK_BITS] + (uint32_t) ((pairs * UINT64_C(0x0001000100010001)) >> 48);
+    step = (uint32_t) (steps >> (8 * position)) & 0xff;
+}
+
+// Sin interpolated from sin_delta_table_v<SIN_TABLE_BITS> instead of sin_table: bit-identical results from a table
+// that takes less cache, for one load and a few arithmetic instructions more per call
+template <int angle_bits, typename Angle_t>
+int32_t SinDelta(Angle_t angle) {
+    constexpr int interp_bits = (angle_bits - 2 - SIN_TABLE_BITS);
+
+    static_assert(interp_bits >= 0, "angle_bits must be at least SIN_TABLE_BITS + 2");
+    static_assert(angle_bits <= 32, "angle_bits must fit in 32 bits");
+
+    constexpr uint32_t interp_max = (UINT32_C(1) << interp_bits);
+    constexpr uint32_t interp_mask = (UINT32_C(1) << interp_bits) - 1;
+
+    constexpr uint32_t angle_half_bit = UINT32_C(1) << (angle_bits - 1);
+    constexpr uint32_t angle_quarter_bit = UINT32_C(1) << (angle_bits - 2);
+
+    using Product_t = std::conditional_t<(interp_bits + 13 - SIN_TABLE_BITS < 32), uint32_t, uint64_t>;
+
+    uint32_t bits = (uint32_t) angle;
+
+    uint32_t index = (bits >> interp_bits) & index_mask;
+    uint32_t interp_pos = bits & interp_mask;
+
+    if ((bits & angle_quarter_bit) != 0) {
+        index = index_mask - index;
+        interp_pos = interp_max - interp_pos;
+    }
+
+    uint32_t value, step;
+    SinDeltaLookup(sin_delta_table_v<SIN_TABLE_BITS>, index, value, step);
+
+    int32_t interpolated = (int32_t) value + (int32_t) ShiftRound<interp_bits>((Product_t) step * interp_pos);
+
+    return (bits & angle_half_bit) == 0 ? interpolated : -interpolated;
+}
+
+// Sin and Cos from a table of one octant, [0, pi/4], instead of a quadrant. Past pi/4 in each quadrant the angle is
+// mirrored and sin and cos swap places, so the table only needs sin over the octant: cos comes from the same table as
+// 1 - 2 sin**2(x/2), with x/2 in [0, pi/8]. As sin stays below 1 in the octant, the entries fit in uint16_t with 16
+// fractional bits. 2**5 steps then take 68 bytes, against the 130 of sin_table at the same angular resolution, and
+// the results are more precise too: within 0.75 LSB of the 12-bit output, where Sin gets to 1.05.
+constexpr int SIN_OCTANT_TABLE_BITS = 5;
+
+inline constexpr const uint16_t (&sin_octant_table)[(1 << SIN_OCTANT_TABLE_BITS) + 2] =
+        sin_octant_table_v<uint16_t, SIN_OCTANT_TABLE_BITS, 16>.values;
+
+// sin_octant_table interpolated at pos / 2**interp_bits table steps
+template <int interp_bits>
+uint32_t SinOctantLookup(uint32_t pos) {
+    // steps are below 2**16 * pi/4 / 2**SIN_OCTANT_TABLE_BITS
+    using Product_t = std::conditional_t<(interp_bits + 16 - SIN_OCTANT_TABLE_BITS < 32), uint32_t, uint64_t>;
+
+    uint32_t index = pos >> interp_bits;
+    uint32_t interp_pos = pos & ((UINT32_C(1) << interp_bits) - 1);
+
+    uint32_t delta = sin_octant_table[index + 1] - sin_octant_table[index];
+    return sin_octant_table[index] + (uint32_t) ShiftRound<interp_bits>((Product_t) delta * interp_pos);
+}
+
+template <int angle_bits, typename Angle_t>
+void SinCosOctant(Angle_t angle, int32_t& sin, int32_t& cos) {
+    constexpr int interp_bits = angle_bits - 3 - SIN_OCTANT_TABLE_BITS;
+
+    static_assert(interp_bits >= 0, "angle_bits must be at least SIN_OCTANT_TABLE_BITS + 3");
+    static_assert(angle_bits <= 32, "angle_bits must fit in 32 bits");
+
+    constexpr uint32_t quarter = UINT32_C(1) << (angle_bits - 2);
+    constexpr uint32_t octant = quarter >> 1;
+
+    uint32_t bits = (uint32_t) angle;
+    uint32_t x = bits & (quarter - 1);
+    uint32_t quadrant = (bits >> (angle_bits - 2)) & 3;
+
+    // past pi/4: sin x = cos(pi/2 - x) and the other way around
+    bool swap = x > octant;
+    uint32_t y = swap ? quarter - x : x;
+
+    // 16 fractional bits; sin(y/2) < sin(pi/8), so its square takes at most 30 bits
+    uint32_t sin_y = SinOctantLookup<interp_bits>(y);
+    uint32_t sin_half_y = SinOctantLookup<interp_bits + 1>(y);
+    uint32_t cos_y = 65536 - ShiftRound<15>(sin_half_y * sin_half_y);
+
+    // odd quadrants swap sin and cos once more; the signs follow the quadrant: sin is negative in the 3rd and 4th, cos
+    // in the 2nd and 3rd
+    bool exchange = swap != ((quadrant & 1) != 0);
+    int32_t sin_abs = (int32_t) ShiftRound<4>(exchange ? cos_y : sin_y);
+    int32_t cos_abs = (int32_t) ShiftRound<4>(exchange ? sin_y : cos_y);
+
+    sin = (quadrant & 2) == 0 ? sin_abs : -sin_abs;
+    cos = ((quadrant + 1) & 2) == 0 ? cos_abs : -cos_abs;
+}
+
+template <int angle_bits, typename Angle_t>
+int32_t SinOctant(Angle_t angle) {
+    int32_t sin, cos;
+    SinCosOctant<angle_bits, Angle_t>(angle, sin, cos);
+    return sin;
+}
+
+template <int angle_bits, typename Angle_t>
+int32_t CosOctant(Angle_t angle) {
+    int32_t sin, cos;
+    SinCosOctant<angle_bits, Angle_t>(angle, sin, cos);
+    return cos;
+}
+
+// A second, finer table with 20 fractional bits, for when Sin is either not precise enough or not fast enough.
+// With order 1 the error stays within 0.52 LSB of the 12-bit result, i.e. practically correctly rounded. With
+// order 0 the nearest entry is returned without interpolating, which saves the multiplication.
+constexpr int SIN_FINE_TABLE_BITS = 8;
+
+inline constexpr const uint32_t (&sin_fine_table)[(1 << SIN_FINE_TABLE_BITS) + 1] =
+        sin_table_v<uint32_t, SIN_FINE_TABLE_BITS, 20>.values;
+
+template <int angle_bits, int interpolation_order, typename Angle_t>
+int32_t SinFine(Angle_t angle) {
+    constexpr int interp_bits = (angle_bits - 2 - SIN_FINE_TABLE_BITS);
+
+    static_assert(interp_bits >= 0, "angle_bits must be at least SIN_FINE_TABLE_BITS + 2");
+    static_assert(angle_bits <= 32, "angle_bits must fit in 32 bits");
+    static_assert(interpolation_order == 0 || interpolation_order == 1, "interpolation_order must be 0 or 1");
+
+    FIXED_POINT_MATH_INSTRUMENT_CALL("SinFine", angle_bits, interpolation_order);
+
+    constexpr uint32_t interp_max = (UINT32_C(1) << interp_bits);
+    constexpr uint32_t interp_mask = (UINT32_C(1) << interp_bits) - 1;
+    constexpr uint32_t fine_index_mask = (UINT32_C(1) << SIN_FINE_TABLE_BITS) - 1;
+
+    constexpr uint32_t angle_half_bit = UINT32_C(1) << (angle_bits - 1);
+    constexpr uint32_t angle_quarter_bit = UINT32_C(1) << (angle_bits - 2);
+
+    // The largest table step is below 2**13
+    using Product_t = std::conditional_t<(interp_bits + 13 < 32), uint32_t, uint64_t>;
+
+    uint32_t bits = (uint32_t) angle;
+
+    uint32_t index = (bits >> interp_bits) & fine_index_mask;
+    uint32_t interp_pos = bits & interp_mask;
+
+    if ((bits & angle_quarter_bit) != 0) {
+        index = fine_index_mask - index;
+        interp_pos = interp_max - interp_pos;
+    }
+
+    uint32_t value;
+
+    if constexpr (interpolation_order == 0) {
+        // round to the nearest entry; interp_pos == interp_max also moves on to the next one
+        value = sin_fine_table[index + ShiftRound<interp_bits>(interp_pos)];
+    }
+    else {
+        uint32_t delta = sin_fine_table[index + 1] - sin_fine_table[index];
+        value = sin_fine_table[index] + (uint32_t) ShiftRound<interp_bits>((Product_t) delta * interp_pos);
+    }
+
+    int32_t result = (int32_t) ShiftRound<8>(value);
+
+    return (bits & angle_half_bit) == 0 ? result : -result;
+}
+
 template <int angle_bits, typename Angle_t>
 int32_t Cos(Angle_t angle) {
-    constexpr int half_pi_radians = 1 << (angle_bits - 2);
+    constexpr uint32_t half_pi_radians = UINT32_C(1) << (angle_bits - 2);
+
+    // Add in unsigned arithmetic, which wraps around instead of overflowing for narrow signed angles
+    return Sin<angle_bits, uint32_t>((uint32_t) angle + half_pi_radians);
+}
+
+// sin with 30 fractional bits (range of +/- 2**30), for angles of up to 32 bits such as the phase accumulators of
+// oscillators, where the 12-bit Sin gives away most of the precision.
+//
+// A table covering every angle would take gigabytes, so the folded angle is split into a coarse part a, the top
+// SIN_Q30_COARSE_BITS bits, and the fine part b below it: sin(a + b) = sin a + sin a (cos b - 1) + cos a sin b.
+// sin a and cos a come from one quarter-wave table of 2**SIN_Q30_COARSE_BITS + 1 entries (8 KiB), read forwards and
+// backwards. b is below pi/2 / 2**SIN_Q30_COARSE_BITS, small enough that b - b**3/6 and -b**2/2 are sin b and
+// cos b - 1 to within 10**-3 of an output LSB, which leaves no need for a second table. The table and the products
+// keep 6 bits beyond the output, so the result is within 0.53 LSB of the exact value: rounded to nearest, but for a
+// few angles very close to half-way.
+constexpr int SIN_Q30_COARSE_BITS = 10;
+
+template <int angle_bits, typename Angle_t>
+int32_t SinQ30(Angle_t angle) {
+    static_assert(angle_bits >= SIN_Q30_COARSE_BITS + 2 && angle_bits <= 32,
+                  "angle_bits must be between SIN_Q30_COARSE_BITS + 2 and 32");
+
+    FIXED_POINT_MATH_INSTRUMENT_CALL("SinQ30", angle_bits, -1);
+
+    constexpr int quarter_bits = angle_bits - 2;
+    constexpr int fine_bits = quarter_bits - SIN_Q30_COARSE_BITS;
+    constexpr uint32_t quarter = UINT32_C(1) << quarter_bits;
+    constexpr uint32_t fine_mask = (UINT32_C(1) << fine_bits) - 1;
+
+    // radians per fine step, with 62 fractional bits; fine * fine_step is then below 2**53
+    constexpr int64_t fine_step = (int64_t) (1.5707963267948966192313216916397514L *
+                                             (long double) (INT64_C(1) << (62 - quarter_bits)) + 0.5L);
+
+    const auto& quarter_wave = sin_table_v<uint64_t, SIN_Q30_COARSE_BITS, 36>.values;
+
+    uint32_t bits = (uint32_t) angle;
+    uint32_t x = bits & (quarter - 1);
+
+    if ((bits & quarter) != 0) {
+        x = quarter - x;
+    }
+
+    uint32_t coarse = x >> fine_bits;
+    uint32_t fine = x & fine_mask;
+
+    // Everything below has 36 fractional bits, so that cos_a * sin_b < 2**36 * 2**26.7 still fits in 64 bits
+    int64_t b = ShiftRound<26>((int64_t) fine * fine_step);
+    int64_t b2 = ShiftRound<36>(b * b);
+    int64_t sin_b = b - (ShiftRound<36>(b2 * b) + 3) / 6;
+    int64_t cos_b_minus_1 = -ShiftRound<1>(b2);
+
+    int64_t sin_a = (int64_t) quarter_wave[coarse];
+    int64_t cos_a = (int64_t) quarter_wave[(1 << SIN_Q30_COARSE_BITS) - coarse];
+
+    int64_t value = sin_a + ShiftRound<36>(sin_a * cos_b_minus_1 + cos_a * sin_b);
+    int32_t result = (int32_t) ShiftRound<6>(value);
+
+    return (bits & (quarter << 1)) == 0 ? result : -result;
+}
+
+template <int angle_bits, typename Angle_t>
+int32_t CosQ30(Angle_t angle) {
+    constexpr uint32_t half_pi_radians = UINT32_C(1) << (angle_bits - 2);
 
-    return Sin<angle_bits, Angle_t>(angle + half_pi_radians);
+    return SinQ30<angle_bits, uint32_t>((uint32_t) angle + half_pi_radians);
 }
 
 #endif
@@ -0,0 +1,205 @@
+#ifndef FIXED_POINT_MATH_SIN_TABLE_HPP
+#define FIXED_POINT_MATH_SIN_TABLE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Quarter-wave sine tables, generated at compile time.
+//
+// SinTable<T, table_bits, frac_bits> holds sin(i / 2**table_bits * pi/2) * 2**frac_bits, rounded to nearest, for i in
+// [0, 2**table_bits]. Each entry is evaluated with a Taylor series in long double, on an argument reduced to
+// [0, pi/4], which leaves it many orders of magnitude closer than half a unit to the exact value; only 0 and 1 are
+// rational here, so no entry lies on a rounding tie. sin_cos.cpp checks every table in use against libm.
+
+// Anything between 0 and pi/4
+constexpr long double SinSeries(long double x) {
+    long double x2 = x * x;
+    long double term = x;
+    long double sum = x;
+
+    // the next term, x**23 / 23!, is below 10**-25 for x <= pi/4
+    for (int n = 3; n <= 21; n += 2) {
+        term = -term * x2 / ((n - 1) * n);
+        sum += term;
+    }
+
+    return sum;
+}
+
+constexpr long double CosSeries(long double x) {
+    long double x2 = x * x;
+    long double term = 1;
+    long double sum = 1;
+
+    for (int n = 2; n <= 22; n += 2) {
+        term = -term * x2 / ((n - 1) * n);
+        sum += term;
+    }
+
+    return sum;
+}
+
+template <typename T, int table_bits, int frac_bits>
+struct SinTable {
+    static_assert(table_bits >= 0 && table_bits <= 20, "table_bits must be between 0 and 20");
+    static_assert(frac_bits >= 1 && frac_bits < (int) sizeof(T) * 8, "frac_bits must leave room for 1.0 in T");
+
+    static constexpr size_t size = (size_t(1) << table_bits) + 1;
+
+    T values[size];
+};
+
+template <typename T, int table_bits, int frac_bits>
+constexpr SinTable<T, table_bits, frac_bits> MakeSinTable() {
+    constexpr long double half_pi = 1.570796326794896619231321691639751442L;
+    constexpr int64_t quarter = int64_t(1) << table_bits;
+    constexpr long double one = (long double) (int64_t(1) << frac_bits);
+
+    SinTable<T, table_bits, frac_bits> table = {};
+
+    for (int64_t i = 0; i <= quarter; i++) {
+        // past pi/4, sin(x) = cos(pi/2 - x)
+        long double sin = (2 * i <= quarter) ? SinSeries(half_pi * i / quarter)
+                                             : CosSeries(half_pi * (quarter - i) / quarter);
+
+        table.values[i] = (T) (int64_t) (sin * one + 0.5L);
+    }
+
+    return table;
+}
+
+// One instance per table, shared by every translation unit
+template <typename T, int table_bits, int frac_bits>
+inline constexpr SinTable<T, table_bits, frac_bits> sin_table_v = MakeSinTable<T, table_bits, frac_bits>();
+
+// sin(i / 2**angle_bits * 2pi) * 2**frac_bits for every i in [0, 2**angle_bits), i.e. over a full turn, unfolded
+// from the quarter-wave table so that the rounding is the same
+template <typename T, int angle_bits, int frac_bits>
+struct SinPeriodTable {
+    static_assert(angle_bits >= 2 && angle_bits <= 16, "angle_bits must be between 2 and 16");
+
+    static constexpr size_t size = size_t(1) << angle_bits;
+
+    T values[size];
+};
+
+template <typename T, int angle_bits, int frac_bits>
+constexpr SinPeriodTable<T, angle_bits, frac_bits> MakeSinPeriodTable() {
+    constexpr size_t quarter = size_t(1) << (angle_bits - 2);
+    const auto& quarter_wave = sin_table_v<T, angle_bits - 2, frac_bits>.values;
+
+    SinPeriodTable<T, angle_bits, frac_bits> table = {};
+
+    for (size_t i = 0; i < quarter; i++) {
+        table.values[i] = quarter_wave[i];
+        table.values[quarter + i] = quarter_wave[quarter - i];
+        table.values[2 * quarter + i] = (T) -quarter_wave[i];
+        table.values[3 * quarter + i] = (T) -quarter_wave[quarter - i];
+    }
+
+    return table;
+}
+
+template <typename T, int angle_bits, int frac_bits>
+inline constexpr SinPeriodTable<T, angle_bits, frac_bits> sin_period_table_v =
+        MakeSinPeriodTable<T, angle_bits, frac_bits>();
+
+// sin(i / 2**table_bits * pi/4) * 2**frac_bits for i in [0, 2**table_bits + 1]: half of a quarter-wave table, for
+// folding angles into an octant. The one entry past pi/4 lets interpolation reach pi/4 itself without a bounds check.
+template <typename T, int table_bits, int frac_bits>
+struct SinOctantTable {
+    static_assert(table_bits >= 1 && table_bits <= 16, "table_bits must be between 1 and 16");
+    // with at least 2 steps per octant, even the entry past pi/4 is below sin(3pi/8) < 1
+    static_assert(frac_bits >= 1 && frac_bits <= (int) sizeof(T) * 8, "frac_bits must fit in T");
+
+    static constexpr size_t size = (size_t(1) << table_bits) + 2;
+
+    T values[size];
+};
+
+template <typename T, int table_bits, int frac_bits>
+constexpr SinOctantTable<T, table_bits, frac_bits> MakeSinOctantTable() {
+    constexpr long double quarter_pi = 0.785398163397448309615660845819875721L;
+    constexpr int64_t octant = int64_t(1) << table_bits;
+    constexpr long double one = (long double) (int64_t(1) << frac_bits);
+
+    SinOctantTable<T, table_bits, frac_bits> table = {};
+
+    for (int64_t i = 0; i <= octant + 1; i++) {
+        long double sin = (i <= octant) ? SinSeries(quarter_pi * i / octant)
+                                        : CosSeries(quarter_pi * (2 * octant - i) / octant);
+
+        table.values[i] = (T) (int64_t) (sin * one + 0.5L);
+    }
+
+    return table;
+}
+
+template <typename T, int table_bits, int frac_bits>
+inline constexpr SinOctantTable<T, table_bits, frac_bits> sin_octant_table_v =
+        MakeSinOctantTable<T, table_bits, frac_bits>();
+
+// sin_table_v<uint16_t, table_bits, 12> in about 60% of the space: 8-bit steps instead of 16-bit values, with a 16-bit
+// base at the start of every block of 2**SIN_DELTA_BLOCK_BITS entries. steps[i] = values[i + 1] - values[i], which
+// is at most 4096 sin(pi/2 / 2**table_bits) and therefore fits in a byte from 2**5 entries up. values[i] is the base
+// of its block plus the steps before i in that block, so one base and one aligned group of 8 steps give both the
+// value and the slope for interpolating from it. The table is cache line aligned, so for table_bits = 6 its 80 bytes
+// take two cache lines, where the 130 of the plain table take three or four.
+constexpr int SIN_DELTA_BLOCK_BITS = 3;
+
+template <int table_bits>
+struct alignas(64) SinDeltaTable {
+    static_assert(table_bits >= 5 && table_bits <= 16, "table_bits must be between 5 and 16");
+
+    static constexpr size_t num_steps = size_t(1) << table_bits;
+    static constexpr size_t num_blocks = num_steps >> SIN_DELTA_BLOCK_BITS;
+
+    uint8_t steps[num_steps];
+    uint16_t bases[num_blocks];
+
+    // values[i] for i in [0, num_steps]
+    constexpr uint32_t Value(size_t i) const {
+        size_t block = (i < num_steps) ? (i >> SIN_DELTA_BLOCK_BITS) : num_blocks - 1;
+        uint32_t value = bases[block];
+
+        for (size_t j = block << SIN_DELTA_BLOCK_BITS; j < i; j++) {
+            value += steps[j];
+        }
+
+        return value;
+    }
+
+    // All num_steps + 1 values at once
+    constexpr void Decode(uint16_t* values) const {
+        uint32_t value = bases[0];
+
+        for (size_t i = 0; i < num_steps; i++) {
+            values[i] = (uint16_t) value;
+            value += steps[i];
+        }
+
+        values[num_steps] = (uint16_t) value;
+    }
+};
+
+template <int table_bits>
+constexpr SinDeltaTable<table_bits> MakeSinDeltaTable() {
+    const auto& values = sin_table_v<uint16_t, table_bits, 12>.values;
+
+    SinDeltaTable<table_bits> table = {};
+
+    for (size_t i = 0; i < table.num_steps; i++) {
+        table.steps[i] = (uint8_t) (values[i + 1] - values[i]);
+
+        if (i % (size_t(1) << SIN_DELTA_BLOCK_BITS) == 0) {
+            table.bases[i >> SIN_DELTA_BLOCK_BITS] = values[i];
+        }
+    }
+
+    return table;
+}
+
+template <int table_bits>
+inline constexpr SinDeltaTable<table_bits> sin_delta_table_v = MakeSinDeltaTable<table_bits>();
+
+#endif
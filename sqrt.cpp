@@ -129,3 +129,33 @@ TEST_CASE("Sqrtu") {
     CHECK_LE(abs((int) Sqrtu(         4) - (int) round(sqrt(         4))),   1);
     CHECK_LE(abs((int) Sqrtu(   4194304) - (int) round(sqrt(   4194304))),  21);
 }
+
+// r**2 <= number < (r + 1)**2, in 64 bits
+static bool IsFloorSqrt(uint32_t number, uint32_t root) {
+    return (uint64_t) root * root <= number && (uint64_t) (root + 1) * (root + 1) > number;
+}
+
+TEST_CASE("SqrtFloorU8, SqrtFloorU16, SqrtFloorU24") {
+    for (uint32_t number = 0; number < 256; number++) {
+        INFO("number = " << number);
+        REQUIRE(IsFloorSqrt(number, SqrtFloorU8((uint8_t) number)));
+    }
+
+    for (uint32_t number = 0; number < 65536; number++) {
+        INFO("number = " << number);
+        REQUIRE(IsFloorSqrt(number, SqrtFloorU16((uint16_t) number)));
+    }
+
+    // every 24-bit number, as the rounding argument in sqrt.hpp has little margin at the top
+    uint32_t num_wrong = 0;
+
+    for (uint32_t number = 0; number < (1 << 24); number++) {
+        num_wrong += !IsFloorSqrt(number, SqrtFloorU24(number));
+    }
+
+    CHECK_EQ(num_wrong, 0);
+
+    CHECK_EQ(SqrtFloorU24((1 << 24) - 1), 4095);
+    CHECK_EQ(SqrtFloorU24(4095 * 4095), 4095);
+    CHECK_EQ(SqrtFloorU24(4095 * 4095 - 1), 4094);
+}
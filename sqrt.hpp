@@ -1,8 +1,10 @@
 #ifndef FIXED_POINT_MATH_SQRT_HPP
 #define FIXED_POINT_MATH_SQRT_HPP
 
+#include <math.h>
 #include <stdint.h>
 
+#include "instrument.hpp"
 #include "log2.hpp"
 
 // Implementation is based on http://www.cs.uni.edu/~jacobson/C++/newton.html
@@ -12,6 +14,7 @@ uint32_t Sqrtu(uint32_t number) {
     if (!number) {
         // special case because call to Log2u(0) is invalid
         // better (faster + correct) solution available ?
+        FIXED_POINT_MATH_INSTRUMENT_ITERATIONS("Sqrtu", TOLERANCE_BITS, MAX_ITERATIONS, 0, false);
         return 0;
     }
 
@@ -36,6 +39,7 @@ uint32_t Sqrtu(uint32_t number) {
         num_iterations++;
     }
 
+    FIXED_POINT_MATH_INSTRUMENT_ITERATIONS("Sqrtu", TOLERANCE_BITS, MAX_ITERATIONS, num_iterations, upper - lower > tol);
     return (lower + upper) / 2;
 }
 
@@ -45,6 +49,7 @@ uint32_t Sqrtu(uint32_t number, int* num_iterations_out) {
         // special case because call to Log2u(0) is invalid
         // better (faster + correct) solution available ?
         *num_iterations_out = 0;
+        FIXED_POINT_MATH_INSTRUMENT_ITERATIONS("Sqrtu", TOLERANCE_BITS, MAX_ITERATIONS, 0, false);
         return 0;
     }
 
@@ -69,8 +74,48 @@ uint32_t Sqrtu(uint32_t number, int* num_iterations_out) {
         num_iterations++;
     }
 
+    FIXED_POINT_MATH_INSTRUMENT_ITERATIONS("Sqrtu", TOLERANCE_BITS, MAX_ITERATIONS, num_iterations, upper - lower > tol);
     *num_iterations_out = num_iterations;
     return (lower + upper) / 2;
 }
 
+// floor(sqrt(number)), exactly, for inputs known to be narrow, each by the fastest method for its width. For 8 bits
+// that is a table of 256 bytes. Up to 24 bits, the number converts to float exactly and sqrtf rounds correctly, so
+// truncating its result could only go wrong where sqrt(number) is within half an ulp below an integer k. The closest
+// case is number = k**2 - 1 with k = 4096: 1/2k + 1/8k**3 = 2**-13 + 2**-39 below k, just more than half an ulp
+// (2**-13 for results in [2048, 4096)), so it rounds down and truncating gives the floor throughout.
+struct SqrtU8Table {
+    uint8_t values[256];
+};
+
+constexpr SqrtU8Table MakeSqrtU8Table() {
+    SqrtU8Table table = {};
+    uint32_t root = 0;
+
+    for (uint32_t number = 0; number < 256; number++) {
+        if ((root + 1) * (root + 1) <= number) {
+            root++;
+        }
+
+        table.values[number] = (uint8_t) root;
+    }
+
+    return table;
+}
+
+inline constexpr SqrtU8Table sqrt_u8_table = MakeSqrtU8Table();
+
+inline uint32_t SqrtFloorU8(uint8_t number) {
+    return sqrt_u8_table.values[number];
+}
+
+inline uint32_t SqrtFloorU16(uint16_t number) {
+    return (uint32_t) sqrtf((float) number);
+}
+
+// number must be below 2**24
+inline uint32_t SqrtFloorU24(uint32_t number) {
+    return (uint32_t) sqrtf((float) number);
+}
+
 #endif
@@ -0,0 +1,86 @@
+#include "tan.hpp"
+
+#include <doctest.h>
+
+#include <math.h>
+
+// Checks every angle against tan(), to within 1 LSB or a relative 2**-12
+template <int angle_bits>
+static void CheckTan() {
+    constexpr int64_t num_angles = INT64_C(1) << angle_bits;
+
+    for (int64_t angle = 0; angle < num_angles; angle++) {
+        int32_t result = Tan<angle_bits, int32_t>((int32_t) angle);
+
+        if ((angle & (num_angles / 2 - 1)) == num_angles / 4) {
+            REQUIRE_EQ(result, INT32_MAX);
+            continue;
+        }
+
+        double exact = tan(2 * M_PI * (double) angle / (double) num_angles) * 4096;
+        exact = fmax(fmin(exact, INT32_MAX), -INT32_MAX);
+
+        INFO("angle = " << angle);
+        REQUIRE_LE(fabs(result - exact), fmax(1.0, fabs(exact) / 4096));
+    }
+}
+
+// Every entry against libm, rounded to nearest
+template <int table_bits>
+static void CheckTanTable() {
+    const auto& table = tan_table_v<table_bits>.values;
+    const size_t last = (size_t) 1 << table_bits;
+
+    for (size_t i = 0; i <= last; i++) {
+        INFO("table_bits = " << table_bits << ", i = " << i);
+        REQUIRE_EQ(table[i], (uint32_t) round(tan((double) i / (double) last * M_PI / 4) * 2147483648.0));
+    }
+}
+
+TEST_CASE("TanTable") {
+    CheckTanTable<5>();
+    CheckTanTable<6>();
+    CheckTanTable<7>();
+    CheckTanTable<10>();
+
+    for (size_t i = 0; i < TanReciprocalTable::size; i++) {
+        INFO("i = " << i);
+        REQUIRE_EQ(tan_reciprocal_table[i], (uint32_t) round(1073741824.0 / (0.5 + (i + 0.5) / 128)));
+    }
+}
+
+TEST_CASE("TanReciprocal") {
+    CHECK_EQ(TanReciprocal(0), INT32_MAX);
+    CHECK_EQ(TanReciprocal(UINT32_C(1) << 12), INT32_MAX);
+    CHECK_EQ(TanReciprocal(UINT32_C(1) << 31), 4096);
+    CHECK_EQ(TanReciprocal(UINT32_C(1) << 30), 8192);
+
+    for (uint64_t t = 4097; t <= UINT32_MAX; t = t * 9 / 8 + 1) {
+        double exact = 4096.0 * 2147483648.0 / (double) t;
+        REQUIRE_LE(fabs(TanReciprocal((uint32_t) t) - fmin(exact, INT32_MAX)), fmax(1.0, exact / 8192));
+    }
+}
+
+TEST_CASE("Tan<angle_bits, int32_t>(int32_t)") {
+    CHECK_EQ(Tan<12, int32_t>(0), 0);
+    CHECK_EQ(Tan<12, int32_t>(512), 4096);
+    CHECK_EQ(Tan<12, int32_t>(-512), -4096);
+    CHECK_EQ(Tan<12, int32_t>(1536), -4096);
+    CHECK_EQ(Tan<12, int32_t>(2048), 0);
+
+    // poles, and their neighbours saturating in the right direction
+    CHECK_EQ(Tan<12, int32_t>(1024), INT32_MAX);
+    CHECK_EQ(Tan<12, int32_t>(3072), INT32_MAX);
+    CHECK_EQ(Tan<12, int32_t>(-1024), INT32_MAX);
+    CHECK_EQ(Tan<24, int32_t>((1 << 22) - 1), INT32_MAX);
+    CHECK_EQ(Tan<24, int32_t>((1 << 22) + 1), -INT32_MAX);
+
+    CheckTan<12>();
+    CheckTan<16>();
+}
+
+TEST_CASE("Tan<16, int16_t>(int16_t)") {
+    for (int32_t i = INT16_MIN; i <= INT16_MAX; i++) {
+        REQUIRE_EQ(Tan<16, int16_t>((int16_t) i), Tan<16, int32_t>(i & 0xffff));
+    }
+}
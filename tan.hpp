@@ -0,0 +1,108 @@
+#ifndef FIXED_POINT_MATH_TAN_HPP
+#define FIXED_POINT_MATH_TAN_HPP
+
+#include <stdint.h>
+
+#include <type_traits>
+
+#include "arith.hpp"
+#include "instrument.hpp"
+#include "log2.hpp"
+#include "tan_table.hpp"
+
+// Angles are the same as for Sin; the output has 12 fractional bits like Sin, but is not bounded.
+// Results that do not fit in 32 bits saturate at +/-INT32_MAX. The poles themselves give INT32_MAX.
+//
+// Only tan over the first octant [0, pi/4] is tabulated. The second octant uses tan(x) = 1 / tan(pi/2 - x), with
+// the reciprocal computed by Newton's method from a small seed table, so there is no division anywhere.
+
+// 6 bits: MAX ERROR within 1 LSB or a relative 2**-12, whichever is larger
+#define TAN_TABLE_BITS 6
+
+// tan over [0, pi/4] in Q31, and the reciprocal seeds for TanReciprocal; see tan_table.hpp
+inline constexpr const uint32_t (&tan_table)[TanTable<TAN_TABLE_BITS>::size] = tan_table_v<TAN_TABLE_BITS>.values;
+inline constexpr const uint32_t (&tan_reciprocal_table)[TanReciprocalTable::size] = tan_reciprocal_table_v.values;
+
+// 1 / t in Q12 for t in Q31, saturated to INT32_MAX. Every Newton step doubles the number of correct bits of the
+// 7-bit seed; one step is already finer than the table of tan itself near the poles.
+template <int newton_steps = 1>
+int32_t TanReciprocal(uint32_t t) {
+    // anything up to 2**-19 has a reciprocal of 2**19 = 2**31 in Q12 or more
+    if (t <= (UINT32_C(1) << 12)) {
+        return INT32_MAX;
+    }
+
+    // t = m * 2**(n - 31) with m in [2**31, 2**32), i.e. 0.5 <= m / 2**32 < 1 and t / 2**31 = m / 2**32 * 2**(n - 30)
+    // not Log2floor, which is a call into the library unless header-only
+    int n = 31 - __builtin_clz(t);
+    uint32_t m = t << (31 - n);
+
+    // reciprocal of m / 2**32 in Q30
+    uint64_t r = tan_reciprocal_table[(m >> 25) & 63];
+
+    for (int step = 0; step < newton_steps; step++) {
+        uint64_t mr = ((uint64_t) m * r) >> 32;
+        r = (r * ((UINT64_C(1) << 31) - mr)) >> 30;
+    }
+
+    // 1 / t is then r * 2**-30 * 2**(30 - n), which in Q12 is r * 2**(12 - n)
+    int shift = n - 12;
+    uint64_t result = (r + ((UINT64_C(1) << shift) >> 1)) >> shift;
+
+    return result > INT32_MAX ? INT32_MAX : (int32_t) result;
+}
+
+template <int angle_bits, typename Angle_t, int newton_steps = 1>
+int32_t Tan(Angle_t angle) {
+    // number of bits per 0.25pi radians
+    constexpr int interp_bits = (angle_bits - 3 - TAN_TABLE_BITS);
+
+    static_assert(interp_bits >= 0, "angle_bits must be at least TAN_TABLE_BITS + 3");
+    static_assert(angle_bits <= 32, "angle_bits must fit in 32 bits");
+
+    FIXED_POINT_MATH_INSTRUMENT_CALL("Tan", angle_bits, newton_steps);
+
+    constexpr uint32_t interp_max = (UINT32_C(1) << interp_bits);
+    constexpr uint32_t interp_mask = (UINT32_C(1) << interp_bits) - 1;
+    constexpr uint32_t index_mask = (UINT32_C(1) << TAN_TABLE_BITS) - 1;
+
+    constexpr uint32_t angle_quarter_bit = UINT32_C(1) << (angle_bits - 2);
+    constexpr uint32_t angle_eighth_bit = UINT32_C(1) << (angle_bits - 3);
+
+    // The largest table step is below 2**26
+    using Product_t = std::conditional_t<(interp_bits + 26 < 32), uint32_t, uint64_t>;
+
+    // tan repeats every half turn, so only the low angle_bits - 1 bits matter
+    uint32_t bits = (uint32_t) angle;
+    uint32_t quarter_pos = bits & (angle_quarter_bit - 1);
+    bool negative = (bits & angle_quarter_bit) != 0;
+
+    // The octant changes at random for random angles, so everything from here on is branchless; a mispredicted branch
+    // costs more than the reciprocal. The pole at 0.5pi maps to quarter_pos = angle_quarter_bit, and t = 0 there.
+    bool pole = negative && quarter_pos == 0;
+
+    // 2nd quarter: tan(x) = -tan(pi - x)
+    quarter_pos = negative ? angle_quarter_bit - quarter_pos : quarter_pos;
+
+    uint32_t index = (quarter_pos >> interp_bits) & index_mask;
+    uint32_t interp_pos = quarter_pos & interp_mask;
+    bool upper_octant = (quarter_pos & angle_eighth_bit) != 0;
+
+    // mirror around 0.25pi, to the complementary angle: index_mask - index and interp_max - interp_pos. Written with
+    // a mask, as the compiler turns the plain conditional into a branch. interp_pos may become interp_max here.
+    uint32_t mirror = UINT32_C(0) - (uint32_t) upper_octant;
+    index ^= mirror & index_mask;
+    interp_pos = (interp_pos ^ mirror) - mirror + (mirror & interp_max);
+
+    // The table is increasing, so the step is never negative
+    uint32_t delta = tan_table[index + 1] - tan_table[index];
+    uint32_t t = tan_table[index] + (uint32_t) ShiftRound<interp_bits>((Product_t) delta * interp_pos);
+
+    int32_t reciprocal = TanReciprocal<newton_steps>(t);
+    int32_t direct = (int32_t) ShiftRound<19>(t);
+    int32_t result = upper_octant ? reciprocal : direct;
+
+    return pole ? INT32_MAX : negative ? -result : result;
+}
+
+#endif
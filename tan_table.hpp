@@ -0,0 +1,64 @@
+#ifndef FIXED_POINT_MATH_TAN_TABLE_HPP
+#define FIXED_POINT_MATH_TAN_TABLE_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "sin_table.hpp"
+
+// Tables for Tan, generated at compile time.
+//
+// TanTable<table_bits> holds tan(i / 2**table_bits * pi/4) * 2**31, rounded to nearest, for i in [0, 2**table_bits].
+// Each entry is the quotient of SinSeries and CosSeries, close enough to the exact value that the rounding comes out
+// right; only 0 and 1 are rational here, so no entry lies on a rounding tie. tan.cpp checks the tables against libm.
+template <int table_bits>
+struct TanTable {
+    static_assert(table_bits >= 0 && table_bits <= 20, "table_bits must be between 0 and 20");
+
+    static constexpr size_t size = (size_t(1) << table_bits) + 1;
+
+    uint32_t values[size];
+};
+
+template <int table_bits>
+constexpr TanTable<table_bits> MakeTanTable() {
+    constexpr long double quarter_pi = 0.785398163397448309615660845819875721L;
+    constexpr int64_t last = int64_t(1) << table_bits;
+
+    TanTable<table_bits> table = {};
+
+    for (int64_t i = 0; i <= last; i++) {
+        long double x = quarter_pi * i / last;
+        long double tan = SinSeries(x) / CosSeries(x);
+
+        table.values[i] = (uint32_t) (int64_t) (tan * 2147483648.0L + 0.5L);
+    }
+
+    return table;
+}
+
+template <int table_bits>
+inline constexpr TanTable<table_bits> tan_table_v = MakeTanTable<table_bits>();
+
+// Seeds for TanReciprocal: 1 / m in Q30 for m in the middle of [0.5 + i / 128, 0.5 + (i + 1) / 128), rounded to
+// nearest. That is 2**38 / (129 + 2 i), worked out exactly in integers; with an odd divisor it is never a tie.
+struct TanReciprocalTable {
+    static constexpr size_t size = 64;
+
+    uint32_t values[size];
+};
+
+constexpr TanReciprocalTable MakeTanReciprocalTable() {
+    TanReciprocalTable table = {};
+
+    for (size_t i = 0; i < table.size; i++) {
+        uint64_t divisor = 129 + 2 * i;
+        table.values[i] = (uint32_t) (((UINT64_C(1) << 39) + divisor) / (2 * divisor));
+    }
+
+    return table;
+}
+
+inline constexpr TanReciprocalTable tan_reciprocal_table_v = MakeTanReciprocalTable();
+
+#endif
@@ -0,0 +1,63 @@
+#include "verify.hpp"
+
+#include <doctest.h>
+
+static void Identity(const uint32_t* inputs, uint32_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = inputs[i];
+    }
+}
+
+// wrong for every input divisible by 1000
+static void IdentityWithErrors(const uint32_t* inputs, uint32_t* out, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = (inputs[i] % 1000 == 0) ? inputs[i] + 1 : inputs[i];
+    }
+}
+
+TEST_CASE("VerifyRange") {
+    ThreadPool pool(3);
+    VerifyConfig config = {&pool, 5};
+
+    auto pass = VerifyRange<uint32_t>(Identity, Identity, 7, 12'345'678, config);
+    CHECK_EQ(pass.num_checked, 12'345'678 - 7);
+    CHECK_EQ(pass.num_mismatches, 0);
+    CHECK(pass.mismatches.empty());
+
+    // ranges that do not start or end on a block
+    auto fail = VerifyRange<uint32_t>(IdentityWithErrors, Identity, 999, 2'000'001, config);
+    CHECK_EQ(fail.num_checked, 2'000'001 - 999);
+    CHECK_EQ(fail.num_mismatches, 2000);
+    REQUIRE_EQ(fail.mismatches.size(), 5);
+
+    for (size_t i = 0; i < fail.mismatches.size(); i++) {
+        CHECK_EQ(fail.mismatches[i].input, 1000 * (i + 1));
+        CHECK_EQ(fail.mismatches[i].expected, 1000 * (i + 1));
+        CHECK_EQ(fail.mismatches[i].got, 1000 * (i + 1) + 1);
+    }
+
+    // the top of the 32-bit range
+    auto top = VerifyRange<uint32_t>(IdentityWithErrors, Identity, UINT32_MAX - 9999, UINT64_C(1) << 32, config);
+    CHECK_EQ(top.num_checked, 10000);
+    CHECK_EQ(top.num_mismatches, 10);
+
+    auto empty = VerifyRange<uint32_t>(IdentityWithErrors, Identity, 100, 100, config);
+    CHECK_EQ(empty.num_checked, 0);
+    CHECK_EQ(empty.num_mismatches, 0);
+}
+
+TEST_CASE("VerifyRange with several candidates") {
+    ThreadPool pool(2);
+    VerifyConfig config = {&pool, 3};
+
+    auto results = VerifyRange<uint32_t>({Identity, IdentityWithErrors, Identity}, Identity, 500, 1'000'500, config);
+    REQUIRE_EQ(results.size(), 3);
+
+    CHECK_EQ(results[0].num_checked, 1'000'000);
+    CHECK_EQ(results[0].num_mismatches, 0);
+    CHECK_EQ(results[1].num_checked, 1'000'000);
+    CHECK_EQ(results[1].num_mismatches, 1000);
+    REQUIRE_EQ(results[1].mismatches.size(), 3);
+    CHECK_EQ(results[1].mismatches[0].input, 1000);
+    CHECK_EQ(results[2].num_mismatches, 0);
+}
@@ -0,0 +1,126 @@
+#ifndef FIXED_POINT_MATH_VERIFY_HPP
+#define FIXED_POINT_MATH_VERIFY_HPP
+
+#include <algorithm>
+#include <mutex>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <vector>
+
+#include "parallel.hpp"
+
+// Exhaustive verification of a batch kernel against a reference over a range of 32-bit inputs.
+//
+// Inputs are generated, and both kernels evaluated, a block at a time; a block whose outputs compare equal as a
+// whole costs a single memcmp, so the cost is dominated by the kernels themselves. Only mismatches are recorded.
+// Blocks are spread over a thread pool.
+
+template <typename Out_t>
+using VerifyKernel = void (*)(const uint32_t* inputs, Out_t* out, size_t count);
+
+template <typename Out_t>
+struct Mismatch {
+    uint32_t input;
+    Out_t expected;
+    Out_t got;
+};
+
+template <typename Out_t>
+struct VerifyResult {
+    uint64_t num_checked = 0;
+    uint64_t num_mismatches = 0;
+    std::vector<Mismatch<Out_t>> mismatches;    // those for the lowest inputs, at most max_recorded of them
+};
+
+struct VerifyConfig {
+    ThreadPool* pool = nullptr;                 // nullptr: DefaultThreadPool()
+    size_t max_recorded = 16;
+};
+
+constexpr size_t VERIFY_BLOCK_SIZE = 4096;
+constexpr size_t VERIFY_BLOCKS_PER_CHUNK = 256;
+
+// Checks candidate(x) == reference(x) for every x in [begin, end) and every candidate; end may be 2**32.
+// The reference is evaluated only once per input, however many candidates there are.
+template <typename Out_t>
+std::vector<VerifyResult<Out_t>> VerifyRange(const std::vector<VerifyKernel<Out_t>>& candidates,
+                                             VerifyKernel<Out_t> reference, uint64_t begin, uint64_t end,
+                                             const VerifyConfig& config = {}) {
+    constexpr uint64_t chunk_size = VERIFY_BLOCK_SIZE * VERIFY_BLOCKS_PER_CHUNK;
+
+    std::vector<VerifyResult<Out_t>> results(candidates.size());
+    std::mutex mutex;
+
+    if (end <= begin) {
+        return results;
+    }
+
+    auto by_input = [](const auto& a, const auto& b) { return a.input < b.input; };
+
+    size_t num_chunks = (size_t) ((end - begin + chunk_size - 1) / chunk_size);
+    ThreadPool& pool = config.pool ? *config.pool : DefaultThreadPool();
+
+    pool.ParallelFor(num_chunks, [&](size_t chunk) {
+        uint32_t inputs[VERIFY_BLOCK_SIZE];
+        Out_t expected[VERIFY_BLOCK_SIZE];
+        Out_t got[VERIFY_BLOCK_SIZE];
+
+        uint64_t chunk_begin = begin + chunk * chunk_size;
+        uint64_t chunk_end = std::min(end, chunk_begin + chunk_size);
+
+        for (uint64_t block = chunk_begin; block < chunk_end; block += VERIFY_BLOCK_SIZE) {
+            size_t count = (size_t) std::min<uint64_t>(VERIFY_BLOCK_SIZE, chunk_end - block);
+
+            for (size_t i = 0; i < count; i++) {
+                inputs[i] = (uint32_t) (block + i);
+            }
+
+            reference(inputs, expected, count);
+
+            for (size_t c = 0; c < candidates.size(); c++) {
+                candidates[c](inputs, got, count);
+
+                if (memcmp(expected, got, count * sizeof(Out_t)) == 0) {
+                    continue;
+                }
+
+                std::lock_guard<std::mutex> lock(mutex);
+                auto& result = results[c];
+
+                for (size_t i = 0; i < count; i++) {
+                    if (expected[i] != got[i]) {
+                        result.num_mismatches++;
+                        result.mismatches.push_back({inputs[i], expected[i], got[i]});
+                    }
+                }
+
+                // keep the memory bounded even if everything fails
+                if (result.mismatches.size() > 2 * config.max_recorded + VERIFY_BLOCK_SIZE) {
+                    std::sort(result.mismatches.begin(), result.mismatches.end(), by_input);
+                    result.mismatches.resize(config.max_recorded);
+                }
+            }
+        }
+    });
+
+    for (auto& result : results) {
+        std::sort(result.mismatches.begin(), result.mismatches.end(), by_input);
+
+        if (result.mismatches.size() > config.max_recorded) {
+            result.mismatches.resize(config.max_recorded);
+        }
+
+        result.num_checked = end - begin;
+    }
+
+    return results;
+}
+
+template <typename Out_t>
+VerifyResult<Out_t> VerifyRange(VerifyKernel<Out_t> candidate, VerifyKernel<Out_t> reference,
+                                uint64_t begin, uint64_t end, const VerifyConfig& config = {}) {
+    return VerifyRange(std::vector<VerifyKernel<Out_t>>{candidate}, reference, begin, end, config)[0];
+}
+
+#endif